@@ -0,0 +1,19 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exe
+MAIN=$PARENT_DIR/src/main_auto.cpp
+PROG=$PARENT_DIR/src/MaxFlowSolverAuto
+
+# Compile the program (both engines are linked, the engine is chosen at run time)
+g++ -pthread $MAIN -o $PROG -lz
+
+
+# Run the solver, letting it choose the engine from the statistics of the graph
+$PROG $PARENT_DIR/inputs/input3.txt $PARENT_DIR/outputs/output.txt --engine auto
+echo "Graph saved to $PARENT_DIR/outputs/output.txt"
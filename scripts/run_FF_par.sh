@@ -17,7 +17,7 @@ MON=$PARENT_DIR/src/ThreadMonitor.hpp
 # Compile the program
 #---------
 ### max flow solver parallel THREAD POOL ver
-g++  $MAIN $SOLVER $NODE $EDGE $LOG $MON -o  $PROG -g
+g++  $MAIN $SOLVER $NODE $EDGE $LOG $MON -o  $PROG -g -lz
 ###
 #---------
 ## max flow solver parallel MANY THREADS
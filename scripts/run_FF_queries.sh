@@ -0,0 +1,21 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exe
+MAIN=$PARENT_DIR/src/main_queries.cpp
+PROG=$PARENT_DIR/src/MaxFlowQueries
+
+# Compile the program
+g++ -O2 -pthread $MAIN -o $PROG -lz
+
+
+# Run a batch of s-t queries on the airports network
+QUERIES=$PARENT_DIR/outputs/queries.txt
+printf "0 499\n0 250\n10 499\n110 282\n" > $QUERIES
+$PROG $PARENT_DIR/inputs/airports_500_dag.txt $QUERIES $PARENT_DIR/outputs/queries_result.txt
+echo "Results saved to $PARENT_DIR/outputs/queries_result.txt"
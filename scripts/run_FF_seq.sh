@@ -13,7 +13,7 @@ MAIN=$PARENT_DIR/src/main.cpp
 PROG=$PARENT_DIR/src/MaxFlowSolver
 
 # Compile the program
-g++ $MAIN $SOLVER $EDGE -o $PROG
+g++ $MAIN $SOLVER $EDGE -o $PROG -lz
 
 
 # Run the solver
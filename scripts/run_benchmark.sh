@@ -0,0 +1,20 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exe
+MAIN=$PARENT_DIR/src/benchmark.cpp
+PROG=$PARENT_DIR/src/MaxFlowBenchmark
+
+# Compile the benchmark (all the engines are linked)
+g++ -O2 -pthread $MAIN -o $PROG -lz
+
+
+# Run every engine on every graph of inputs/ with up to 100K edges
+# (results can be loaded in notebooks/benchmarks.ipynb with pandas.read_csv / read_json)
+$PROG --inputs $PARENT_DIR/inputs --engines sequential,parallel,queries --warmup 1 --trials 5 --max-edges 100000 \
+      --csv $PARENT_DIR/outputs/benchmark.csv --json $PARENT_DIR/outputs/benchmark.json
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exe
+MAIN=$PARENT_DIR/src/checker.cpp
+PROG=$PARENT_DIR/src/FlowChecker
+
+# Compile the program
+g++ -O2 -pthread $MAIN -o $PROG -lz
+
+
+# Check the output of the last solve on the default dataset
+$PROG $PARENT_DIR/inputs/input3.txt $PARENT_DIR/outputs/output.txt
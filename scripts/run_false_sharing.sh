@@ -0,0 +1,41 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exes
+MAIN=$PARENT_DIR/src/main_auto.cpp
+PADDED=$PARENT_DIR/src/MaxFlowSolverPadded
+PACKED=$PARENT_DIR/src/MaxFlowSolverPacked
+
+# Input graph and thread counts, e.g. ./scripts/run_false_sharing.sh ./inputs/dag_1000_60000.txt "8 16 32"
+INPUT=${1:-$PARENT_DIR/inputs/dag_1000_60000.txt}
+THREADS=${2:-"4 8 16 32"}
+OUTPUT=$PARENT_DIR/outputs/false_sharing.txt
+
+if ! command -v perf > /dev/null; then
+    echo "perf is required (linux-tools), and perf_event_paranoid <= 1 for the HITM counts"
+    exit 1
+fi
+
+# Compile the program twice: shared atomics on separate cache lines (default), and packed as before
+g++ -O2 -pthread $MAIN -o $PADDED -lz
+g++ -O2 -pthread -DMAXFLOW_NO_PADDING $MAIN -o $PACKED -lz
+
+# Cache misses of both layouts, then the loads that hit a line modified by another core (HITM)
+: > $OUTPUT
+for threads in $THREADS; do
+    for prog in $PACKED $PADDED; do
+        echo "== $(basename $prog), $threads threads" | tee -a $OUTPUT
+        perf stat -e cache-references,cache-misses,L1-dcache-load-misses,LLC-load-misses -r 5 \
+             $prog $INPUT $PARENT_DIR/outputs/output.txt --engine parallel --threads $threads > /dev/null 2>> $OUTPUT
+        perf c2c record -o $PARENT_DIR/outputs/perf.c2c.data -- \
+             $prog $INPUT $PARENT_DIR/outputs/output.txt --engine parallel --threads $threads > /dev/null 2>&1
+        perf c2c report -i $PARENT_DIR/outputs/perf.c2c.data --stdio 2> /dev/null | grep -E "HITM" | head -6 >> $OUTPUT
+    done
+done
+rm -f $PARENT_DIR/outputs/perf.c2c.data
+echo "Counters saved to $OUTPUT"
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exe
+MAIN=$PARENT_DIR/src/generator.cpp
+PROG=$PARENT_DIR/src/GraphGenerator
+
+# Compile the program
+g++ -O2 -pthread $MAIN -o $PROG
+
+
+# Generate a random DAG with 1M nodes and 6M edges
+$PROG $PARENT_DIR/inputs/dag_1000000_6000000.txt --family dag --nodes 1000000 --edges 6000000 --seed 1
@@ -0,0 +1,26 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the programs & the exes
+SERVER_MAIN=$PARENT_DIR/src/server.cpp
+SERVER=$PARENT_DIR/src/MaxFlowServer
+CLIENT_MAIN=$PARENT_DIR/src/client.cpp
+CLIENT=$PARENT_DIR/src/MaxFlowClient
+
+# Compile the programs
+g++ -O2 -pthread $SERVER_MAIN -o $SERVER -lz
+g++ -O2 -pthread $CLIENT_MAIN -o $CLIENT
+
+
+# Start the server with the airports network loaded, send a few requests, then stop it
+SOCKET=/tmp/maxflow.sock
+$SERVER $SOCKET --load airports=$PARENT_DIR/inputs/airports_500_dag.txt &
+while [ ! -S $SOCKET ]; do sleep 0.1; done
+
+printf "solve airports 0 499\ncut airports 0 499\nload dag $PARENT_DIR/inputs/dag_1000_6000.txt\nsolve dag 0 999\nlist\nshutdown\n" | $CLIENT $SOCKET
+wait
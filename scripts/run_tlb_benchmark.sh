@@ -0,0 +1,36 @@
+#!/bin/bash
+
+
+# Get the directory where the script is located
+SCRIPT_DIR=$(dirname $(realpath ${BASH_SOURCE[0]}))
+PARENT_DIR=$(dirname $SCRIPT_DIR) # Get parent directory of SCRIPT_DIR
+
+
+# Get the paths of the program & the exe
+MAIN=$PARENT_DIR/src/main_queries.cpp
+PROG=$PARENT_DIR/src/MaxFlowQueries
+OUTPUT=$PARENT_DIR/outputs/tlb_benchmark.txt
+
+if ! command -v perf > /dev/null; then
+    echo "perf is required (linux-tools)"
+    exit 1
+fi
+
+# Compile the program
+g++ -O2 -pthread $MAIN -o $PROG -lz
+
+
+# TLB and cache misses of the multi-query engine on the 300k-edge inputs, with the default traversal,
+# prefetching, huge pages (transparent huge pages must be "madvise" or "always") and both
+QUERIES=$PARENT_DIR/outputs/tlb_queries.txt
+printf "0 999\n0 500\n250 999\n" > $QUERIES
+: > $OUTPUT
+for input in dag_1000_300000 dag_1000_300k; do
+    for options in "" "--prefetch" "--huge-pages" "--prefetch --huge-pages"; do
+        echo "== $input ${options:-(default)}" | tee -a $OUTPUT
+        perf stat -e dTLB-loads,dTLB-load-misses,cache-misses,cycles -r 3 \
+             $PROG $PARENT_DIR/inputs/$input.txt $QUERIES $PARENT_DIR/outputs/queries_result.txt 1 $options \
+             2>> $OUTPUT | grep "found in" | tee -a $OUTPUT
+    done
+done
+echo "Counters saved to $OUTPUT"
@@ -0,0 +1,181 @@
+// Header file that contains the kernels finding the next admissible arc
+// An arc is admissible if it has remaining capacity and its head is not visited yet. The kernels
+// check 8 arcs at a time with SSE4.1 or AVX2, chosen at run time from the CPU, so that the program
+// is still built without -mavx2 and runs on any x86-64.
+#pragma once
+
+#include <cstdint>
+#include <immintrin.h>
+
+using namespace std;
+
+enum scan_kernel_t {
+    SCAN_SCALAR,
+    SCAN_SSE4,
+    SCAN_AVX2
+};
+
+constexpr const char *scan_kernel_names[] = {"scalar", "sse4", "avx2"};
+
+// the widest kernel supported by the CPU
+inline scan_kernel_t detectScanKernel() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SCAN_AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return SCAN_SSE4;
+    return SCAN_SCALAR;
+}
+
+/**
+ * First admissible arc in [first, last), or last if there is none.
+ * With a prefetch distance d > 0, every kernel prefetches the visited flag of the head of the arc
+ * d positions ahead of the one it checks (the vector kernels a group of 8 arcs at a time).
+ * With unsigned capacities the remaining capacity capacity - flow is exact, so it is positive
+ * exactly when capacity != flow: this is the comparison the vector kernels make.
+ */
+template <typename index_t, typename capacity_t>
+index_t scanArcsScalar(const index_t *head, const capacity_t *capacity, const capacity_t *flow,
+                       const uint32_t *visited, uint32_t visit_flag, index_t first, index_t last,
+                     index_t prefetch_distance = 0) {
+    for (index_t arc = first; arc < last; arc++) {
+        if (prefetch_distance && arc + prefetch_distance < last)
+            __builtin_prefetch(&visited[head[arc + prefetch_distance]]);
+        if (capacity[arc] - flow[arc] > 0 && visited[head[arc]] != visit_flag)
+            return arc;
+    }
+    return last;
+}
+
+// prefetches the visited flags of the heads of the group of 8 arcs from 'first', up to 'last'
+inline void prefetchHeads(const uint32_t *head, const uint32_t *visited, uint32_t first, uint32_t last) {
+    for (uint32_t arc = first; arc < first + 8 && arc < last; arc++)
+        __builtin_prefetch(&visited[head[arc]]);
+}
+
+// the vector kernels only exist for 32-bit ids, the other widths scan one arc at a time
+template <typename index_t, typename capacity_t>
+index_t scanArcsSSE4(const index_t *head, const capacity_t *capacity, const capacity_t *flow,
+                     const uint32_t *visited, uint32_t visit_flag, index_t first, index_t last,
+                     index_t prefetch_distance = 0) {
+    return scanArcsScalar(head, capacity, flow, visited, visit_flag, first, last, prefetch_distance);
+}
+
+template <typename index_t, typename capacity_t>
+index_t scanArcsAVX2(const index_t *head, const capacity_t *capacity, const capacity_t *flow,
+                     const uint32_t *visited, uint32_t visit_flag, index_t first, index_t last,
+                     index_t prefetch_distance = 0) {
+    return scanArcsScalar(head, capacity, flow, visited, visit_flag, first, last, prefetch_distance);
+}
+
+// the arcs of a mask of open arcs (remaining capacity) whose head is not visited, checked one by one
+inline uint32_t unvisitedArcs(const uint32_t *head, const uint32_t *visited, uint32_t visit_flag,
+                              uint32_t first, uint32_t open) {
+    uint32_t fresh = 0;
+    for (uint32_t bits = open; bits != 0; bits &= bits - 1) {
+        int lane = __builtin_ctz(bits);
+        if (visited[head[first + lane]] != visit_flag)
+            fresh |= 1u << lane;
+    }
+    return fresh;
+}
+
+// SSE4.1, 32-bit capacities: two vectors of 4 arcs, then the visited flags of the open arcs
+__attribute__((target("sse4.1")))
+inline uint32_t scanArcsSSE4(const uint32_t *head, const uint32_t *capacity, const uint32_t *flow,
+                      const uint32_t *visited, uint32_t visit_flag, uint32_t first, uint32_t last,
+                      uint32_t prefetch_distance = 0) {
+    uint32_t arc = first;
+    for (; arc + 8 <= last; arc += 8) {
+        if (prefetch_distance)
+            prefetchHeads(head, visited, arc + prefetch_distance, last);
+        __m128i low = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(capacity + arc)),
+                                      _mm_loadu_si128((const __m128i *)(flow + arc)));
+        __m128i high = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(capacity + arc + 4)),
+                                       _mm_loadu_si128((const __m128i *)(flow + arc + 4)));
+        uint32_t saturated = _mm_movemask_ps(_mm_castsi128_ps(low)) | (_mm_movemask_ps(_mm_castsi128_ps(high)) << 4);
+        uint32_t open = ~saturated & 0xFF;
+        uint32_t fresh = open ? unvisitedArcs(head, visited, visit_flag, arc, open) : 0;
+        if (fresh)
+            return arc + __builtin_ctz(fresh);
+    }
+    return scanArcsScalar(head, capacity, flow, visited, visit_flag, arc, last, prefetch_distance);
+}
+
+// SSE4.1, 64-bit capacities: four vectors of 2 arcs
+__attribute__((target("sse4.1")))
+inline uint32_t scanArcsSSE4(const uint32_t *head, const uint64_t *capacity, const uint64_t *flow,
+                      const uint32_t *visited, uint32_t visit_flag, uint32_t first, uint32_t last,
+                      uint32_t prefetch_distance = 0) {
+    uint32_t arc = first;
+    for (; arc + 8 <= last; arc += 8) {
+        if (prefetch_distance)
+            prefetchHeads(head, visited, arc + prefetch_distance, last);
+        uint32_t saturated = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i equal = _mm_cmpeq_epi64(_mm_loadu_si128((const __m128i *)(capacity + arc + 2 * k)),
+                                            _mm_loadu_si128((const __m128i *)(flow + arc + 2 * k)));
+            saturated |= _mm_movemask_pd(_mm_castsi128_pd(equal)) << (2 * k);
+        }
+        uint32_t open = ~saturated & 0xFF;
+        uint32_t fresh = open ? unvisitedArcs(head, visited, visit_flag, arc, open) : 0;
+        if (fresh)
+            return arc + __builtin_ctz(fresh);
+    }
+    return scanArcsScalar(head, capacity, flow, visited, visit_flag, arc, last, prefetch_distance);
+}
+
+// AVX2: the visited flags of the open arcs are gathered, the others keep visit_flag (not admissible).
+// The gather takes signed indices, so the network must have fewer than 2^31 nodes.
+__attribute__((target("avx2")))
+inline uint32_t unvisitedArcsAVX2(const uint32_t *head, const uint32_t *visited, uint32_t visit_flag,
+                                  uint32_t first, uint32_t open) {
+    __m256i flags = _mm256_set1_epi32(visit_flag);
+    __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(open), lanes), lanes);
+    __m256i heads = _mm256_loadu_si256((const __m256i *)(head + first));
+    __m256i flags_of_heads = _mm256_mask_i32gather_epi32(flags, (const int *)visited, heads, mask, 4);
+    uint32_t seen = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(flags_of_heads, flags)));
+    return ~seen & open;
+}
+
+// AVX2, 32-bit capacities: one vector of 8 arcs
+__attribute__((target("avx2")))
+inline uint32_t scanArcsAVX2(const uint32_t *head, const uint32_t *capacity, const uint32_t *flow,
+                      const uint32_t *visited, uint32_t visit_flag, uint32_t first, uint32_t last,
+                      uint32_t prefetch_distance = 0) {
+    uint32_t arc = first;
+    for (; arc + 8 <= last; arc += 8) {
+        if (prefetch_distance)
+            prefetchHeads(head, visited, arc + prefetch_distance, last);
+        __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(capacity + arc)),
+                                           _mm256_loadu_si256((const __m256i *)(flow + arc)));
+        uint32_t open = ~_mm256_movemask_ps(_mm256_castsi256_ps(equal)) & 0xFF;
+        uint32_t fresh = open ? unvisitedArcsAVX2(head, visited, visit_flag, arc, open) : 0;
+        if (fresh)
+            return arc + __builtin_ctz(fresh);
+    }
+    return scanArcsScalar(head, capacity, flow, visited, visit_flag, arc, last, prefetch_distance);
+}
+
+// AVX2, 64-bit capacities: two vectors of 4 arcs
+__attribute__((target("avx2")))
+inline uint32_t scanArcsAVX2(const uint32_t *head, const uint64_t *capacity, const uint64_t *flow,
+                      const uint32_t *visited, uint32_t visit_flag, uint32_t first, uint32_t last,
+                      uint32_t prefetch_distance = 0) {
+    uint32_t arc = first;
+    for (; arc + 8 <= last; arc += 8) {
+        if (prefetch_distance)
+            prefetchHeads(head, visited, arc + prefetch_distance, last);
+        __m256i low = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(capacity + arc)),
+                                         _mm256_loadu_si256((const __m256i *)(flow + arc)));
+        __m256i high = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(capacity + arc + 4)),
+                                          _mm256_loadu_si256((const __m256i *)(flow + arc + 4)));
+        uint32_t saturated = _mm256_movemask_pd(_mm256_castsi256_pd(low)) | (_mm256_movemask_pd(_mm256_castsi256_pd(high)) << 4);
+        uint32_t open = ~saturated & 0xFF;
+        uint32_t fresh = open ? unvisitedArcsAVX2(head, visited, visit_flag, arc, open) : 0;
+        if (fresh)
+            return arc + __builtin_ctz(fresh);
+    }
+    return scanArcsScalar(head, capacity, flow, visited, visit_flag, arc, last, prefetch_distance);
+}
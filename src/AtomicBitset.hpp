@@ -0,0 +1,68 @@
+// Header file that contains class AtomicBitset
+// One bit per node, in 64-bit atomic words: a scan over the neighbours of a node reads n / 8 bytes
+// in total instead of one cache line per neighbour, and a bit is set with a single fetch_or.
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+class AtomicBitset {
+    private:
+        vector<atomic<uint64_t>> words;
+        int size;
+
+    public:
+        AtomicBitset() : size(0) {}
+
+        // n bits, all cleared
+        AtomicBitset(int n) {
+            resize(n);
+        }
+
+        // drops every bit and holds n cleared bits, not to be called while other threads use the bitset
+        void resize(int n) {
+            this->size = n;
+            this->words = vector<atomic<uint64_t>>((n + 63) / 64);
+            clearAll();
+        }
+
+        int getSize() const {
+            return this->size;
+        }
+
+        // acquire: once the bit is seen, the data written before set() is visible
+        bool test(int i) const {
+            return (this->words[i >> 6].load(memory_order_acquire) >> (i & 63)) & 1;
+        }
+
+        /**
+         * Sets bit i.
+         * @return true if the bit was cleared before, i.e. the calling thread is the one that set it
+         */
+        bool set(int i) {
+            uint64_t mask = 1ULL << (i & 63);
+            return (this->words[i >> 6].fetch_or(mask, memory_order_acq_rel) & mask) == 0;
+        }
+
+        void clear(int i) {
+            this->words[i >> 6].fetch_and(~(1ULL << (i & 63)), memory_order_release);
+        }
+
+        // clears every bit, one word at a time
+        void clearAll() {
+            for (atomic<uint64_t> &word : this->words)
+                word.store(0, memory_order_relaxed);
+            atomic_thread_fence(memory_order_release);
+        }
+
+        // number of set bits, one popcount per word
+        int count() const {
+            int total = 0;
+            for (const atomic<uint64_t> &word : this->words)
+                total += __builtin_popcountll(word.load(memory_order_relaxed));
+            return total;
+        }
+};
@@ -0,0 +1,17 @@
+// Header file that contains the cache line constants
+// Atomics written by different threads are kept on separate cache lines: otherwise every write
+// invalidates the line of the flags that the other threads are polling (false sharing).
+#pragma once
+
+#include <cstddef>
+
+// std::hardware_destructive_interference_size is not provided by every compiler, 64 bytes on x86-64 and most ARM cores
+const size_t CACHE_LINE_SIZE = 64;
+
+// Starts a control block on a new cache line. With -DMAXFLOW_NO_PADDING the blocks are packed
+// as before, to measure the false sharing (scripts/run_false_sharing.sh)
+#ifdef MAXFLOW_NO_PADDING
+#define CACHE_ALIGNED
+#else
+#define CACHE_ALIGNED alignas(CACHE_LINE_SIZE)
+#endif
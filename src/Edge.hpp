@@ -1,4 +1,5 @@
 // Header file that contains class Edge
+#pragma once
 #include <string>
 #include <atomic>
 
@@ -46,6 +47,12 @@ class Edge {
             return this->end_node;
         }
 
+        // change the ids of the end points (used when the graph is compacted)
+        void setNodes(int start_node, int end_node) {
+            this->start_node = start_node;
+            this->end_node = end_node;
+        }
+
         void setResidual(Edge *edge_residual) {
             this->residual = edge_residual;
             return;
@@ -70,6 +77,12 @@ class Edge {
             return this->flow;
         }
 
+        // set the flow of an edge directly, keeping its residual edge consistent
+        void setFlow(long flow) {
+            this->flow = flow;
+            residual->flow = -flow;
+        }
+
         // return remaining capacity of edge
         long getRemainingCapacity() {
             return this->capacity - this->flow;
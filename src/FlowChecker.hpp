@@ -0,0 +1,364 @@
+// Header file that contains class FlowChecker
+// Checks that an output file of the solvers is a maximum flow: capacity bounds on every edge,
+// conservation at every node, and a cut of the residual graph whose capacity equals the flow.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "FlowNetwork.hpp"
+#include "FlowWriter.hpp"
+
+using namespace std;
+
+// result of a check, the flow is a maximum flow if valid is true
+typedef struct {
+    bool valid;
+    long flow_value;            // net flow leaving the source(s)
+    long cut_capacity;          // capacity of the edges from the reachable nodes to the others
+    long capacity_violations;   // edges with a flow < 0 or > capacity
+    long conservation_violations; // nodes (not terminals) whose inflow differs from their outflow
+    bool sink_reachable;        // an augmenting path is left, the flow is not maximum
+    int reachable_nodes;        // source side of the cut
+    string error;
+} certificate_t;
+
+class FlowChecker {
+    private:
+        const FlowNetwork &network;
+
+        // flow of every arc: the flow of the edge on its forward arc, the opposite on the residual one
+        vector<long> arc_flow;
+
+        int num_threads;
+
+        // runs body(first, last, thread_id) on num_threads ranges of [0, size)
+        template <typename Body>
+        void parallelFor(int size, Body body) {
+            int threads = max(1, min(this->num_threads, size));
+            int chunk = (size + threads - 1) / max(1, threads);
+            vector<thread> workers;
+            for (int k = 0; k < threads; k++) {
+                int first = k * chunk, last = min(size, first + chunk);
+                workers.emplace_back([&body, first, last, k] { body(first, last, k); });
+            }
+            for (thread &worker : workers) {
+                worker.join();
+            }
+        }
+
+        // 1 for the arcs of the input edges that the solvers write, 0 for the residual ones. An edge of
+        // capacity 0 looks residual to the solvers (Edge::isResidual()) and is not in their output files,
+        // it can only carry no flow
+        vector<char> forwardArcs() const {
+            vector<char> is_forward(this->network.getNumArcs(), 0);
+            for (int i = 0; i < this->network.getNumEdges(); i++) {
+                int arc = this->network.getEdgeArc(i);
+                is_forward[arc] = this->network.getCapacity(arc) != 0;
+            }
+            return is_forward;
+        }
+
+        // number of edges in the output files, see forwardArcs()
+        long numOutputEdges() const {
+            vector<char> is_forward = forwardArcs();
+            return count(is_forward.begin(), is_forward.end(), 1);
+        }
+
+        // residual capacity of an arc with the flow read from the file
+        long remaining(int arc) const {
+            return this->network.getCapacity(arc) - this->arc_flow[arc];
+        }
+
+    public:
+        /**
+         * @param network topology and capacities of the input file
+         * @param num_threads threads of the checks, 0 means hardware concurrency
+         */
+        FlowChecker(const FlowNetwork &network, int num_threads = 0) : network(network) {
+            this->arc_flow = vector<long>(network.getNumArcs(), 0);
+            this->num_threads = num_threads > 0 ? num_threads : std::thread::hardware_concurrency();
+            this->num_threads = max(1, this->num_threads);
+        }
+
+        /**
+         * Reads the flows of an output file, one "node1 node2 flow" line per edge of the input file with a
+         * non-zero capacity, grouped by start node in input order (the order of printGraphToFile()). A DIMACS solution
+         * (printDimacsFlowToFile()) has the same edges as "f node1 node2 flow" lines with 1-based ids,
+         * after "c" and "s" lines that are skipped. After a "c nonzero flows" line the edges without
+         * flow are missing, and a binary output (OUTPUT_BINARY) has the flows of all the edges.
+         * @return an empty string, or the reason why the file does not match the input file
+         */
+        string readFlowFile(string flow_file_path) {
+            ifstream file(flow_file_path, ios::binary);
+            if (!file.is_open()) {
+                return "failed to open file: " + flow_file_path;
+            }
+
+            char magic[8] = {};
+            file.read(magic, sizeof(magic));
+            if (file.gcount() == sizeof(magic) && equal(magic, magic + 8, BINARY_FLOW_MAGIC)) {
+                return readBinaryFlows(file);
+            }
+            file.clear();
+            file.seekg(0);
+
+            // forward arcs in arc order are exactly the edges in the order of the output file
+            vector<char> is_forward = forwardArcs();
+
+            char *end;
+            string line;
+            int arc = 0;
+            int line_number = 0;
+            bool nonzero_only = false;
+            while (getline(file, line)) {
+                line_number++;
+                if (line + "\n" == NONZERO_FLOWS_LINE)
+                    nonzero_only = true;
+                if (line + "\n" == CUT_EDGES_LINE)
+                    return "the output file has only the edges of the cut, not a flow";
+                if (line.empty() || line[0] == 'c' || line[0] == 's')
+                    continue;
+                // DIMACS "f" lines: skip the letter, the ids are 1-based
+                int offset = line[0] == 'f' ? 1 : 0;
+
+                // assuming format "node1 node2 flow"
+                int start_node = strtol(line.c_str() + offset, &end, 10) - offset;
+                int end_node = strtol(end + 1, &end, 10) - offset;
+                long flow = strtol(end + 1, &end, 10);
+
+                // the missing edges of a "nonzero flows" file have no flow, they are skipped
+                while (arc < this->network.getNumArcs() && (!is_forward[arc] || (nonzero_only &&
+                       (start_node != this->network.getTail(arc) || end_node != this->network.getHead(arc)))))
+                    arc++;
+                if (arc == this->network.getNumArcs()) {
+                    return nonzero_only ? "edge " + to_string(start_node) + " " + to_string(end_node) + " at line " +
+                                          to_string(line_number) + " is not in the order of the input file"
+                                        : "more edges than in the input file at line " + to_string(line_number);
+                }
+                if (start_node != this->network.getTail(arc) || end_node != this->network.getHead(arc)) {
+                    return "edge " + to_string(start_node) + " " + to_string(end_node) + " at line " +
+                           to_string(line_number) + " is not in the order of the input file";
+                }
+                this->arc_flow[arc] = flow;
+                this->arc_flow[this->network.getReverse(arc)] = -flow;
+                arc++;
+            }
+
+            while (arc < this->network.getNumArcs() && !is_forward[arc])
+                arc++;
+            if (arc != this->network.getNumArcs() && !nonzero_only) {
+                return "fewer edges than in the input file";
+            }
+            return "";
+        }
+
+        // the flows of a binary output, after its magic: one 64-bit flow per edge in output order
+        string readBinaryFlows(ifstream &file) {
+            binary_flow_header_t header;
+            file.read((char *)&header, sizeof(header));
+            long num_edges = numOutputEdges();
+            if (!file || header.num_edges != num_edges) {
+                return "the binary output file does not have the " + to_string(num_edges) +
+                       " edges of the input file";
+            }
+            vector<int64_t> flows(header.num_edges);
+            file.read((char *)flows.data(), flows.size() * sizeof(int64_t));
+            if (!file) {
+                return "the binary output file is truncated";
+            }
+            // forward arcs in arc order are the edges in output order
+            vector<char> is_forward = forwardArcs();
+            size_t i = 0;
+            for (int arc = 0; arc < this->network.getNumArcs(); arc++) {
+                if (!is_forward[arc])
+                    continue;
+                this->arc_flow[arc] = flows[i];
+                this->arc_flow[this->network.getReverse(arc)] = -flows[i];
+                i++;
+            }
+            return "";
+        }
+
+        /**
+         * Checks the flow read by readFlowFile(), in parallel over the arcs and the nodes:
+         * 1. 0 <= flow <= capacity on every edge
+         * 2. inflow == outflow at every node that is not a terminal
+         * 3. the sinks are not reachable from the sources in the residual graph, and the edges leaving
+         *    the reachable nodes (a cut) have a total capacity equal to the flow
+         * @param sources, sinks the terminals of the solve; empty means the terminals of the input file
+         */
+        certificate_t check(vector<int> sources = {}, vector<int> sinks = {}) {
+            certificate_t result = {false, 0, 0, 0, 0, false, 0, ""};
+            int n = this->network.getNumNodes();
+            if (sources.empty())
+                sources.push_back(this->network.getSource());
+            if (sinks.empty())
+                sinks.push_back(this->network.getSink());
+
+            // a terminal listed twice counts once, as in the solvers
+            sort(sources.begin(), sources.end());
+            sources.erase(unique(sources.begin(), sources.end()), sources.end());
+            sort(sinks.begin(), sinks.end());
+            sinks.erase(unique(sinks.begin(), sinks.end()), sinks.end());
+
+            vector<char> terminal(n, 0);
+            for (int source : sources) {
+                if (source < 0 || source >= n) {
+                    result.error = "source " + to_string(source) + " out of range";
+                    return result;
+                }
+                terminal[source] = 1;
+            }
+            for (int sink : sinks) {
+                if (sink < 0 || sink >= n) {
+                    result.error = "sink " + to_string(sink) + " out of range";
+                    return result;
+                }
+                if (terminal[sink] == 1) {
+                    result.error = "node " + to_string(sink) + " is both a source and a sink";
+                    return result;
+                }
+                terminal[sink] = 2;
+            }
+
+            // 1. capacity bounds, each thread counts its own violations
+            vector<long> violations(this->num_threads, 0);
+            parallelFor(this->network.getNumEdges(), [this, &violations](int first, int last, int k) {
+                for (int i = first; i < last; i++) {
+                    int arc = this->network.getEdgeArc(i);
+                    if (this->arc_flow[arc] < 0 || this->arc_flow[arc] > this->network.getCapacity(arc))
+                        violations[k]++;
+                }
+            });
+            for (long count : violations)
+                result.capacity_violations += count;
+
+            // 2. conservation: the arcs of a node hold its outflow (forward) and minus its inflow (residual),
+            // so the nodes are split between the threads without any shared write
+            vector<long> net_outflow(n, 0);
+            fill(violations.begin(), violations.end(), 0);
+            parallelFor(n, [this, &net_outflow, &terminal, &violations](int first, int last, int k) {
+                for (int u = first; u < last; u++) {
+                    long net = 0;
+                    for (int arc = this->network.firstArc(u); arc < this->network.lastArc(u); arc++)
+                        net += this->arc_flow[arc];
+                    net_outflow[u] = net;
+                    if (net != 0 && !terminal[u])
+                        violations[k]++;
+                }
+            });
+            for (long count : violations)
+                result.conservation_violations += count;
+
+            long sink_inflow = 0;
+            for (int source : sources)
+                result.flow_value += net_outflow[source];
+            for (int sink : sinks)
+                sink_inflow -= net_outflow[sink];
+            if (sink_inflow != result.flow_value) {
+                result.error = "the sinks receive " + to_string(sink_inflow) + " but the sources send " +
+                               to_string(result.flow_value);
+            }
+
+            // 3. residual reachability from the sources, one BFS level at a time, nodes claimed with an atomic flag
+            vector<atomic<char>> reached(n);
+            for (int u = 0; u < n; u++)
+                reached[u].store(0, memory_order_relaxed);
+            vector<int> frontier;
+            for (int source : sources) {
+                reached[source].store(1, memory_order_relaxed);
+                frontier.push_back(source);
+            }
+            result.reachable_nodes = frontier.size();
+            while (!frontier.empty()) {
+                vector<vector<int>> next(this->num_threads);
+                parallelFor(frontier.size(), [this, &frontier, &next, &reached](int first, int last, int k) {
+                    for (int i = first; i < last; i++) {
+                        int u = frontier[i];
+                        for (int arc = this->network.firstArc(u); arc < this->network.lastArc(u); arc++) {
+                            int v = this->network.getHead(arc);
+                            char expected = 0;
+                            if (remaining(arc) > 0 && reached[v].load(memory_order_relaxed) == 0 &&
+                                reached[v].compare_exchange_strong(expected, 1, memory_order_relaxed))
+                                next[k].push_back(v);
+                        }
+                    }
+                });
+                frontier.clear();
+                for (vector<int> &nodes : next)
+                    frontier.insert(frontier.end(), nodes.begin(), nodes.end());
+                result.reachable_nodes += frontier.size();
+            }
+            for (int sink : sinks)
+                result.sink_reachable = result.sink_reachable || reached[sink].load(memory_order_relaxed);
+
+            // capacity of the cut between the reachable nodes and the others
+            vector<long> capacities(this->num_threads, 0);
+            parallelFor(n, [this, &reached, &capacities](int first, int last, int k) {
+                for (int u = first; u < last; u++) {
+                    if (!reached[u].load(memory_order_relaxed))
+                        continue;
+                    for (int arc = this->network.firstArc(u); arc < this->network.lastArc(u); arc++) {
+                        if (!reached[this->network.getHead(arc)].load(memory_order_relaxed))
+                            capacities[k] += this->network.getCapacity(arc);
+                    }
+                }
+            });
+            for (long capacity : capacities)
+                result.cut_capacity += capacity;
+
+            result.valid = result.error.empty() && result.capacity_violations == 0 &&
+                           result.conservation_violations == 0 && !result.sink_reachable &&
+                           result.cut_capacity == result.flow_value;
+            return result;
+        }
+};
+
+// one line summary of a check
+inline string certificateToString(const certificate_t &certificate) {
+    stringstream ss;
+    ss << (certificate.valid ? "VALID maximum flow" : "INVALID flow") << ": flow " << certificate.flow_value
+       << ", cut capacity " << certificate.cut_capacity << " (" << certificate.reachable_nodes << " nodes on the source side)"
+       << ", capacity violations " << certificate.capacity_violations
+       << ", conservation violations " << certificate.conservation_violations
+       << (certificate.sink_reachable ? ", augmenting path left" : "");
+    if (!certificate.error.empty())
+        ss << ", " << certificate.error;
+    return ss.str();
+}
+
+/**
+ * Loads the output file of a solve and checks its flow against the edges of the input file.
+ * @param num_threads threads of the checks, 0 means hardware concurrency
+ */
+inline certificate_t checkFlowFile(const edge_list_t &edges, string flow_file_path, vector<int> sources = {},
+                            vector<int> sinks = {}, int num_threads = 0) {
+    FlowNetwork network(edges);
+    if (!network.isLoaded()) {
+        return {false, 0, 0, 0, 0, false, 0, "the input file is not loaded"};
+    }
+    FlowChecker checker(network, num_threads);
+    string error = checker.readFlowFile(flow_file_path);
+    if (!error.empty()) {
+        return {false, 0, 0, 0, 0, false, 0, error};
+    }
+    return checker.check(sources, sinks);
+}
+
+// loads the input file and the output file of a solve and checks the flow
+inline certificate_t checkFlowFile(string input_file_path, string flow_file_path, vector<int> sources = {},
+                            vector<int> sinks = {}, int num_threads = 0) {
+    edge_list_t edges = readEdgeList(input_file_path);
+    if (!edges.loaded) {
+        return {false, 0, 0, 0, 0, false, 0, "failed to load " + input_file_path};
+    }
+    return checkFlowFile(edges, flow_file_path, sources, sinks, num_threads);
+}
@@ -0,0 +1,338 @@
+// Header file that contains class FlowNetworkT
+// Read-only topology of a flow network, stored as contiguous arrays (CSR) so
+// that it can be shared by many concurrent solves that only own their flows.
+// The arrays are templated on the width of node/arc ids and of capacities, so that the
+// common graphs (ids and flows below 2^32) move half the bytes of the 64-bit ones.
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <memory>
+
+#include "HugePages.hpp"
+#include "GraphReader.hpp"
+
+using namespace std;
+
+// the arrays of a network stored outside of it (e.g. in a shared memory segment, see SharedGraphStore.hpp)
+template <typename index_t, typename capacity_t>
+struct network_arrays_t {
+    index_t n, m, source, sink;
+    const index_t *first_arc;
+    const index_t *arc_tail;
+    const index_t *arc_head;
+    const capacity_t *arc_capacity;
+    const index_t *arc_reverse;
+    const index_t *edge_arc;
+    shared_ptr<void> owner;     // keeps the memory of the arrays, released with the last network using it
+};
+
+template <typename index_t, typename capacity_t>
+class FlowNetworkT {
+    private:
+        // number of nodes
+        index_t n;
+
+        // number of edges read from the input file (arcs are 2 * m)
+        index_t m;
+
+        // terminals of the input file: node 0 and node n-1, unless the file gives them (DIMACS)
+        index_t source, sink;
+
+        // arcs of node u are in [first_arc[u], first_arc[u + 1])
+        index_t *first_arc;
+
+        // start node, end node and capacity of every arc (residual arcs have capacity 0)
+        index_t *arc_tail;
+        index_t *arc_head;
+        capacity_t *arc_capacity;
+
+        // index of the paired arc (forward <-> residual)
+        index_t *arc_reverse;
+
+        // index of the forward arc created for the i-th input edge
+        index_t *edge_arc;
+
+        // the arrays built from an input file, on huge pages if setHugePages(true) was called before loading
+        huge_vector<index_t> first_arc_storage, arc_tail_storage, arc_head_storage, arc_reverse_storage, edge_arc_storage;
+        huge_vector<capacity_t> arc_capacity_storage;
+
+        // the memory of arrays stored outside (read-only), empty for a network built from a file
+        shared_ptr<void> owner;
+
+        bool loaded;
+
+        void pointToStorage() {
+            this->first_arc = this->first_arc_storage.data();
+            this->arc_tail = this->arc_tail_storage.data();
+            this->arc_head = this->arc_head_storage.data();
+            this->arc_capacity = this->arc_capacity_storage.data();
+            this->arc_reverse = this->arc_reverse_storage.data();
+            this->edge_arc = this->edge_arc_storage.data();
+        }
+
+    public:
+        /**
+         * FlowNetworkT constructor
+         * @param input_file_path path of a file in the format "n" followed by "node1 node2 capacity" lines,
+         *        or in the DIMACS max-flow format (see readEdgeList())
+         *
+         * Arcs of every node keep the order in which they appear in the file, exactly as
+         * the adjacency lists built by MaxFlowSolver::readGraph().
+         */
+        FlowNetworkT(string input_file_path) : FlowNetworkT(readEdgeList(input_file_path)) {}
+
+        // builds the arrays from edges already read, which must fit() the widths
+        FlowNetworkT(const edge_list_t &edges) {
+            this->n = 0;
+            this->m = 0;
+            this->source = this->sink = 0;
+            this->loaded = false;
+            if (!edges.loaded) {
+                this->first_arc_storage = huge_vector<index_t>(1, 0);
+                pointToStorage();
+                return;
+            }
+            this->n = edges.n;
+            this->m = edges.tails.size();
+            this->source = edgeListSource(edges);
+            this->sink = edgeListSink(edges);
+
+            // count the arcs of every node, then place them in input order
+            this->first_arc_storage = huge_vector<index_t>(this->n + 1, 0);
+            this->arc_tail_storage = huge_vector<index_t>(2 * this->m);
+            this->arc_head_storage = huge_vector<index_t>(2 * this->m);
+            this->arc_capacity_storage = huge_vector<capacity_t>(2 * this->m);
+            this->arc_reverse_storage = huge_vector<index_t>(2 * this->m);
+            this->edge_arc_storage = huge_vector<index_t>(this->m);
+            pointToStorage();
+
+            for (index_t i = 0; i < this->m; i++) {
+                this->first_arc[edges.tails[i] + 1]++;
+                this->first_arc[edges.heads[i] + 1]++;
+            }
+            for (index_t u = 0; u < this->n; u++) {
+                this->first_arc[u + 1] += this->first_arc[u];
+            }
+
+            vector<index_t> next_arc(this->first_arc, this->first_arc + this->n);
+
+            for (index_t i = 0; i < this->m; i++) {
+                index_t tail = edges.tails[i], head = edges.heads[i];
+                index_t forward = next_arc[tail]++;
+                index_t residual = next_arc[head]++;
+
+                this->arc_tail[forward] = tail;
+                this->arc_head[forward] = head;
+                this->arc_capacity[forward] = edges.capacities[i];
+                this->arc_reverse[forward] = residual;
+
+                this->arc_tail[residual] = head;
+                this->arc_head[residual] = tail;
+                this->arc_capacity[residual] = 0;
+                this->arc_reverse[residual] = forward;
+
+                this->edge_arc[i] = forward;
+            }
+            this->loaded = true;
+        }
+
+        // uses arrays stored outside, read-only: setEdgeCapacity() refuses every change
+        FlowNetworkT(const network_arrays_t<index_t, capacity_t> &arrays) {
+            this->n = arrays.n;
+            this->m = arrays.m;
+            this->source = arrays.source;
+            this->sink = arrays.sink;
+            this->first_arc = const_cast<index_t *>(arrays.first_arc);
+            this->arc_tail = const_cast<index_t *>(arrays.arc_tail);
+            this->arc_head = const_cast<index_t *>(arrays.arc_head);
+            this->arc_capacity = const_cast<capacity_t *>(arrays.arc_capacity);
+            this->arc_reverse = const_cast<index_t *>(arrays.arc_reverse);
+            this->edge_arc = const_cast<index_t *>(arrays.edge_arc);
+            this->owner = arrays.owner;
+            this->loaded = true;
+        }
+
+        // the arrays point into the object (or are shared with the owner of the mapping)
+        FlowNetworkT(const FlowNetworkT &) = delete;
+        FlowNetworkT &operator=(const FlowNetworkT &) = delete;
+
+        // the arrays, e.g. to copy them into a shared memory segment
+        network_arrays_t<index_t, capacity_t> getArrays() const {
+            return {this->n, this->m, this->source, this->sink, this->first_arc, this->arc_tail, this->arc_head,
+                    this->arc_capacity, this->arc_reverse, this->edge_arc, this->owner};
+        }
+
+        // whether the arrays are stored outside and read-only
+        bool isShared() const {
+            return this->owner != nullptr;
+        }
+
+        // the bound of the flows: capacity_t, and the long returned by the queries
+        static uint64_t maxFlow() {
+            return min<uint64_t>(numeric_limits<capacity_t>::max(), numeric_limits<long>::max());
+        }
+
+        /**
+         * Checks whether the edges fit the widths: every node and arc id in index_t, and every
+         * flow in capacity_t and in a long. A flow through a node is bounded by the total capacity of
+         * its outgoing (or incoming) edges, so the flows of any s-t query fit if the largest of these sums fits.
+         */
+        static bool fits(const edge_list_t &edges) {
+            uint64_t max_index = numeric_limits<index_t>::max();
+            uint64_t max_capacity = maxFlow();
+            if (edges.n > max_index || 2 * edges.tails.size() >= max_index)
+                return false;
+
+            vector<uint64_t> out_capacity(edges.n, 0), in_capacity(edges.n, 0);
+            for (size_t i = 0; i < edges.tails.size(); i++) {
+                uint64_t tail = edges.tails[i], head = edges.heads[i], capacity = edges.capacities[i];
+                if (tail >= edges.n || head >= edges.n)
+                    return false;
+                // written as subtractions, so that the sums cannot wrap around
+                if (capacity > max_capacity - out_capacity[tail] || capacity > max_capacity - in_capacity[head])
+                    return false;
+                out_capacity[tail] += capacity;
+                in_capacity[head] += capacity;
+            }
+            return true;
+        }
+
+        /**
+         * Changes the capacity of the i-th edge of the input file, keeping the bound of fits():
+         * the outgoing capacity of its tail and the incoming capacity of its head must fit maxFlow().
+         * @return false if the capacity is refused
+         */
+        bool setEdgeCapacity(index_t i, uint64_t capacity) {
+            if (isShared())
+                return false;
+            uint64_t max_capacity = maxFlow();
+            index_t forward = this->edge_arc[i];
+            index_t tail = this->arc_tail[forward], head = this->arc_head[forward];
+
+            // the arcs of the tail hold its outgoing capacity, the reverses of the arcs of the head its incoming one
+            uint64_t out_capacity = 0, in_capacity = 0;
+            for (index_t arc = this->first_arc[tail]; arc < this->first_arc[tail + 1]; arc++) {
+                if (arc != forward)
+                    out_capacity += this->arc_capacity[arc];
+            }
+            for (index_t arc = this->first_arc[head]; arc < this->first_arc[head + 1]; arc++) {
+                if (this->arc_reverse[arc] != forward)
+                    in_capacity += this->arc_capacity[this->arc_reverse[arc]];
+            }
+            if (capacity > max_capacity - out_capacity || capacity > max_capacity - in_capacity)
+                return false;
+            this->arc_capacity[forward] = capacity;
+            return true;
+        }
+
+        bool isLoaded() const {
+            return this->loaded;
+        }
+
+        index_t getNumNodes() const {
+            return this->n;
+        }
+
+        index_t getNumEdges() const {
+            return this->m;
+        }
+
+        index_t getNumArcs() const {
+            return 2 * this->m;
+        }
+
+        index_t getSource() const {
+            return this->source;
+        }
+
+        index_t getSink() const {
+            return this->sink;
+        }
+
+        index_t firstArc(index_t u) const {
+            return this->first_arc[u];
+        }
+
+        index_t lastArc(index_t u) const {
+            return this->first_arc[u + 1];
+        }
+
+        index_t getTail(index_t arc) const {
+            return this->arc_tail[arc];
+        }
+
+        index_t getHead(index_t arc) const {
+            return this->arc_head[arc];
+        }
+
+        capacity_t getCapacity(index_t arc) const {
+            return this->arc_capacity[arc];
+        }
+
+        index_t getReverse(index_t arc) const {
+            return this->arc_reverse[arc];
+        }
+
+        // the head and capacity arrays, for the kernels that scan many arcs at a time
+        const index_t *getHeads() const {
+            return this->arc_head;
+        }
+
+        const capacity_t *getCapacities() const {
+            return this->arc_capacity;
+        }
+
+        // forward arc of the i-th edge of the input file
+        index_t getEdgeArc(index_t i) const {
+            return this->edge_arc[i];
+        }
+
+        // bytes of the arrays, to compare the widths
+        size_t getMemoryBytes() const {
+            size_t indices = (size_t)this->n + 1 + 3 * 2 * (size_t)this->m + this->m;
+            return indices * sizeof(index_t) + 2 * (size_t)this->m * sizeof(capacity_t);
+        }
+};
+
+// the layout of the Edge-based solvers (int ids, long capacities)
+typedef FlowNetworkT<int, long> FlowNetwork;
+
+// the instantiations picked at load time by chooseNetworkWidth()
+typedef FlowNetworkT<uint32_t, uint32_t> FlowNetwork32;
+typedef FlowNetworkT<uint32_t, uint64_t> FlowNetwork32Wide;
+typedef FlowNetworkT<uint64_t, uint64_t> FlowNetwork64;
+
+enum network_width_t {
+    NETWORK_32_32,      // 32-bit ids, 32-bit capacities
+    NETWORK_32_64,      // 32-bit ids, 64-bit capacities
+    NETWORK_64_64       // 64-bit ids, 64-bit capacities
+};
+
+constexpr const char *network_width_names[] = {"u32/u32", "u32/u64", "u64/u64"};
+
+// the narrowest instantiation that the edges fit, NETWORK_64_64 if none does (see networkWidthFits())
+inline network_width_t chooseNetworkWidth(const edge_list_t &edges) {
+    if (FlowNetwork32::fits(edges))
+        return NETWORK_32_32;
+    if (FlowNetwork32Wide::fits(edges))
+        return NETWORK_32_64;
+    return NETWORK_64_64;
+}
+
+// whether the edges fit the given instantiation
+inline bool networkWidthFits(const edge_list_t &edges, network_width_t width) {
+    switch (width) {
+        case NETWORK_32_32:
+            return FlowNetwork32::fits(edges);
+        case NETWORK_32_64:
+            return FlowNetwork32Wide::fits(edges);
+        default:
+            return FlowNetwork64::fits(edges);
+    }
+}
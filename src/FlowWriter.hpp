@@ -0,0 +1,293 @@
+// Header file that contains the writers of the output files
+// The lines are formatted by hand into a large buffer, which is written when it is full: no string
+// and no flush per line. The edges can be filtered (non-zero flows, cut edges), written as a binary
+// array of flows, or formatted by several threads into regions of the file sized beforehand.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+enum output_mode_t {
+    OUTPUT_ALL,         // every edge of the input file, in output order
+    OUTPUT_NONZERO,     // only the edges with a flow, after a "c nonzero flows" line
+    OUTPUT_CUT,         // only the edges from the source side to the sink side of the min cut, after a "c cut edges" line
+    OUTPUT_BINARY       // header then the flow of every edge as a 64-bit integer, in output order
+};
+
+constexpr const char *output_mode_names[] = {"all", "nonzero", "cut", "binary"};
+
+// the first line of the filtered outputs, so that the checker knows that edges are missing
+constexpr const char *NONZERO_FLOWS_LINE = "c nonzero flows\n";
+constexpr const char *CUT_EDGES_LINE = "c cut edges\n";
+
+// header of the binary output: magic, number of edges, max flow, then the flows (native byte order)
+const char BINARY_FLOW_MAGIC[8] = {'F', 'L', 'O', 'W', 'B', 'I', 'N', '1'};
+
+typedef struct {
+    int64_t num_edges;
+    int64_t max_flow;
+} binary_flow_header_t;
+
+typedef struct {
+    output_mode_t mode;
+    bool dimacs;        // "f node1 node2 flow" lines with 1-based ids, after "c" and "s" lines
+    int num_threads;    // threads that format the lines, each into its own region of the file
+} output_options_t;
+
+// one edge of the output file
+typedef struct {
+    long start_node;
+    long end_node;
+    long flow;
+} flow_record_t;
+
+// parses the name of an output mode, false if it is unknown
+inline bool parseOutputMode(string name, output_mode_t &mode) {
+    for (int k = 0; k <= OUTPUT_BINARY; k++) {
+        if (name == output_mode_names[k]) {
+            mode = (output_mode_t)k;
+            return true;
+        }
+    }
+    return false;
+}
+
+// number of characters of a number
+inline int formattedLength(long value) {
+    int length = value < 0 ? 2 : 1;
+    unsigned long digits = value < 0 ? -(unsigned long)value : value;
+    for (; digits >= 10; digits /= 10)
+        length++;
+    return length;
+}
+
+// writes the digits of a number at 'out', returns the end
+inline char *formatNumber(char *out, long value) {
+    unsigned long digits = value < 0 ? -(unsigned long)value : value;
+    if (value < 0)
+        *out++ = '-';
+    char reversed[20];
+    int count = 0;
+    do {
+        reversed[count++] = '0' + digits % 10;
+        digits /= 10;
+    } while (digits != 0);
+    while (count > 0)
+        *out++ = reversed[--count];
+    return out;
+}
+
+// the longest line: "f", three numbers of 20 characters, the spaces and the end of line
+const size_t MAX_LINE_LENGTH = 2 + 3 * 21;
+
+// length of the line of an edge, the same as formatLine() writes
+inline size_t lineLength(const flow_record_t &record, bool dimacs) {
+    long offset = dimacs ? 1 : 0;
+    return (dimacs ? 2 : 0) + formattedLength(record.start_node + offset) + 1 +
+           formattedLength(record.end_node + offset) + 1 + formattedLength(record.flow) + 1;
+}
+
+// "node1 node2 flow\n", or "f node1 node2 flow\n" with 1-based ids
+inline char *formatLine(char *out, const flow_record_t &record, bool dimacs) {
+    long offset = dimacs ? 1 : 0;
+    if (dimacs) {
+        *out++ = 'f';
+        *out++ = ' ';
+    }
+    out = formatNumber(out, record.start_node + offset);
+    *out++ = ' ';
+    out = formatNumber(out, record.end_node + offset);
+    *out++ = ' ';
+    out = formatNumber(out, record.flow);
+    *out++ = '\n';
+    return out;
+}
+
+// Writes a file descriptor through a buffer, from its current position or from a given offset (pwrite)
+class BufferedWriter {
+    private:
+        static const size_t BUFFER_SIZE = 1 << 20;
+
+        int fd;
+        vector<char> buffer;
+        size_t used;
+        long offset;        // -1: write() at the current position
+        bool failed;
+
+    public:
+        BufferedWriter(int fd, long offset = -1) : fd(fd), buffer(BUFFER_SIZE), used(0), offset(offset), failed(false) {}
+
+        ~BufferedWriter() {
+            flush();
+        }
+
+        // writes the bytes straight to the file
+        void writeThrough(const char *bytes, size_t size) {
+            size_t done = 0;
+            while (done < size && !this->failed) {
+                ssize_t count = this->offset < 0
+                    ? ::write(this->fd, bytes + done, size - done)
+                    : pwrite(this->fd, bytes + done, size - done, this->offset + done);
+                if (count < 0 && errno == EINTR)
+                    continue;
+                if (count <= 0)
+                    this->failed = true;
+                else
+                    done += count;
+            }
+            if (this->offset >= 0)
+                this->offset += done;
+        }
+
+        void flush() {
+            writeThrough(this->buffer.data(), this->used);
+            this->used = 0;
+        }
+
+        void write(const char *bytes, size_t size) {
+            if (this->used + size > BUFFER_SIZE)
+                flush();
+            if (size > BUFFER_SIZE) {
+                writeThrough(bytes, size);
+                return;
+            }
+            memcpy(this->buffer.data() + this->used, bytes, size);
+            this->used += size;
+        }
+
+        void writeLine(const flow_record_t &record, bool dimacs) {
+            if (this->used + MAX_LINE_LENGTH > BUFFER_SIZE)
+                flush();
+            this->used = formatLine(this->buffer.data() + this->used, record, dimacs) - this->buffer.data();
+        }
+
+        bool hasFailed() const {
+            return this->failed;
+        }
+};
+
+/**
+ * Writes the flow of the edges to a file, or to the standard output if fout is "-" (then with one thread).
+ * @param num_edges number of edges in output order
+ * @param record record(i) is the i-th edge, called by several threads at the same time if num_threads > 1
+ * @param crosses_cut crosses_cut(i) tells whether the i-th edge goes from the source side to the sink side,
+ *        only called with OUTPUT_CUT
+ * @return false if the file cannot be written
+ */
+template <typename Record, typename CrossesCut>
+bool writeFlowFile(string fout, size_t num_edges, Record record, CrossesCut crosses_cut, long max_flow,
+                   output_options_t options) {
+    bool is_stdout = fout == "-";
+    int fd = is_stdout ? STDOUT_FILENO : open(fout.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << fout << std::endl;
+        return false;
+    }
+
+    auto kept = [&](size_t i) {
+        if (options.mode == OUTPUT_NONZERO)
+            return record(i).flow != 0;
+        if (options.mode == OUTPUT_CUT)
+            return crosses_cut(i);
+        return true;
+    };
+
+    // the lines before the edges
+    string header;
+    if (options.mode == OUTPUT_BINARY) {
+        binary_flow_header_t sizes = {(int64_t)num_edges, (int64_t)max_flow};
+        header = string(BINARY_FLOW_MAGIC, 8) + string((const char *)&sizes, sizeof(sizes));
+    }
+    else {
+        if (options.mode == OUTPUT_NONZERO)
+            header += NONZERO_FLOWS_LINE;
+        if (options.mode == OUTPUT_CUT)
+            header += CUT_EDGES_LINE;
+        if (options.dimacs)
+            header += "c max flow solution\ns " + to_string(max_flow) + "\n";
+    }
+
+    // writes the edges of [first, last) from the current position, or from 'offset'
+    auto writeRange = [&](size_t first, size_t last, long offset) {
+        BufferedWriter writer(fd, offset);
+        for (size_t i = first; i < last; i++) {
+            if (options.mode == OUTPUT_BINARY) {
+                int64_t flow = record(i).flow;
+                writer.write((const char *)&flow, sizeof(flow));
+            }
+            else if (kept(i)) {
+                writer.writeLine(record(i), options.dimacs);
+            }
+        }
+        writer.flush();
+        return !writer.hasFailed();
+    };
+
+    bool ok;
+    // the regions need a file that can be sized and written at any offset
+    int threads = is_stdout ? 1 : (int)max<size_t>(1, min<size_t>(max(1, options.num_threads), num_edges));
+    if (threads == 1) {
+        BufferedWriter writer(fd);
+        writer.write(header.data(), header.size());
+        writer.flush();
+        ok = !writer.hasFailed() && writeRange(0, num_edges, -1);
+    }
+    else {
+        // 1. bytes of the lines of every range, 2. their offsets in the file, 3. every thread formats
+        // its range and writes it at its offset, the file is sized first so that no write extends it
+        size_t chunk = (num_edges + threads - 1) / threads;
+        vector<size_t> region_bytes(threads + 1, 0);
+        vector<thread> workers;
+        for (int k = 0; k < threads; k++) {
+            workers.emplace_back([&, k] {
+                size_t first = min(num_edges, k * chunk), last = min(num_edges, first + chunk);
+                size_t bytes = 0;
+                for (size_t i = first; i < last; i++) {
+                    if (options.mode == OUTPUT_BINARY)
+                        bytes += sizeof(int64_t);
+                    else if (kept(i))
+                        bytes += lineLength(record(i), options.dimacs);
+                }
+                region_bytes[k + 1] = bytes;
+            });
+        }
+        for (thread &worker : workers)
+            worker.join();
+        region_bytes[0] = header.size();
+        for (int k = 0; k < threads; k++)
+            region_bytes[k + 1] += region_bytes[k];
+
+        ok = ftruncate(fd, region_bytes[threads]) == 0 &&
+             pwrite(fd, header.data(), header.size(), 0) == (ssize_t)header.size();
+
+        vector<char> region_ok(threads, 0);
+        workers.clear();
+        for (int k = 0; k < threads; k++) {
+            workers.emplace_back([&, k] {
+                size_t first = min(num_edges, k * chunk), last = min(num_edges, first + chunk);
+                region_ok[k] = writeRange(first, last, region_bytes[k]);
+            });
+        }
+        for (thread &worker : workers)
+            worker.join();
+        for (char region : region_ok)
+            ok = ok && region;
+    }
+
+    if (!is_stdout)
+        ok = close(fd) == 0 && ok;
+    if (!ok)
+        std::cerr << "Failed to write file: " << fout << std::endl;
+    return ok;
+}
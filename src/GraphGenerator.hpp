@@ -0,0 +1,283 @@
+// Header file that contains class GraphGenerator
+// Synthetic flow networks of any size, streamed to the input format ("n" then "node1 node2 capacity")
+// without ever holding the edges in memory.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+using namespace std;
+
+// parameters of a generated graph, the meaning of nodes and edges depends on the family
+typedef struct {
+    string family;      // dag, layered, grid, powerlaw, bipartite
+    long nodes;
+    long edges;
+    int layers;         // layered: number of layers (0 means sqrt of the nodes)
+    double exponent;    // powerlaw: larger values give heavier hubs
+    long min_capacity;
+    long max_capacity;
+    uint64_t seed;
+} generator_params_t;
+
+typedef struct {
+    long start_node;
+    long end_node;
+    long capacity;
+} generated_edge_t;
+
+class GraphGenerator {
+    private:
+        generator_params_t params;
+
+        // every family is a list of edge slots, a slot gives one edge or none (e.g. the grid borders)
+        long num_nodes;
+        long num_slots;
+
+        // layered and bipartite: nodes per layer (or side) and edges per node
+        long width;
+        long degree;
+        long left, right;
+
+        // grid: rows x cols cells, the source feeds the first column and the last column feeds the sink
+        long rows, cols;
+
+        // slots generated by one task, with their own random stream
+        static const long CHUNK_SLOTS = 1 << 16;
+
+        // splitmix64: small and fast, with a stream per chunk so the output does not depend on the threads
+        struct Random {
+            uint64_t state;
+
+            Random(uint64_t seed, uint64_t stream) {
+                this->state = seed ^ (stream * 0x9E3779B97F4A7C15ULL);
+                next();
+            }
+
+            uint64_t next() {
+                uint64_t z = (this->state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            // uniform in [0, bound)
+            long below(long bound) {
+                return (long)(((__uint128_t)next() * (uint64_t)bound) >> 64);
+            }
+
+            // uniform in [0, 1)
+            double unit() {
+                return (next() >> 11) * (1.0 / (1ULL << 53));
+            }
+        };
+
+        long capacity(Random &random) {
+            return this->params.min_capacity + random.below(this->params.max_capacity - this->params.min_capacity + 1);
+        }
+
+        // the edge of a slot, false if the slot has no edge
+        bool slot(long i, Random &random, generated_edge_t &edge) {
+            const string &family = this->params.family;
+            long n = this->num_nodes;
+            edge.capacity = capacity(random);
+
+            if (family == "dag") {
+                // edges go from lower to higher ids; the first leaves the source, the last enters the sink
+                long u = i == 0 ? 0 : random.below(n - 1);
+                long v = i == this->num_slots - 1 ? n - 1 : u + 1 + random.below(n - 1 - u);
+                edge.start_node = u;
+                edge.end_node = v;
+                return true;
+            }
+
+            if (family == "layered") {
+                // source -> layer 0, layer k -> layer k + 1 (degree edges per node), last layer -> sink
+                long layers = this->params.layers;
+                long inner = (layers - 1) * this->width * this->degree;
+                if (i < this->width) {
+                    edge.start_node = 0;
+                    edge.end_node = 1 + i;
+                    return true;
+                }
+                i -= this->width;
+                if (i < inner) {
+                    long node = i / this->degree;
+                    long layer = node / this->width;
+                    edge.start_node = 1 + node;
+                    edge.end_node = 1 + (layer + 1) * this->width + random.below(this->width);
+                    return true;
+                }
+                i -= inner;
+                edge.start_node = 1 + (layers - 1) * this->width + i;
+                edge.end_node = n - 1;
+                return true;
+            }
+
+            if (family == "grid") {
+                // road-like: every cell is connected both ways to its right and lower neighbours
+                long cells = this->rows * this->cols;
+                if (i < 4 * cells) {
+                    long cell = i / 4, dir = i % 4;
+                    long r = cell / this->cols, c = cell % this->cols;
+                    long nr = r + (dir == 1 || dir == 3), nc = c + (dir == 0 || dir == 2);
+                    if (nr >= this->rows || nc >= this->cols)
+                        return false;
+                    long other = nr * this->cols + nc;
+                    edge.start_node = 1 + (dir < 2 ? cell : other);
+                    edge.end_node = 1 + (dir < 2 ? other : cell);
+                    return true;
+                }
+                i -= 4 * cells;
+                if (i < this->rows) {
+                    edge.start_node = 0;
+                    edge.end_node = 1 + i * this->cols;
+                    return true;
+                }
+                i -= this->rows;
+                edge.start_node = 1 + i * this->cols + this->cols - 1;
+                edge.end_node = n - 1;
+                return true;
+            }
+
+            if (family == "powerlaw") {
+                // ids drawn as n * x^exponent: the hubs are the low ids as tails and the high ids as
+                // heads, so the source and the sink are the busiest nodes
+                long u = i == 0 ? 0 : min(n - 1, (long)(n * pow(random.unit(), this->params.exponent)));
+                long v = i == this->num_slots - 1 ? n - 1 : n - 1 - min(n - 1, (long)(n * pow(random.unit(), this->params.exponent)));
+                if (u == v)
+                    return false;
+                edge.start_node = u;
+                edge.end_node = v;
+                return true;
+            }
+
+            // bipartite: source -> every left node, random left -> right edges, every right node -> sink
+            if (i < this->left) {
+                edge.start_node = 0;
+                edge.end_node = 1 + i;
+                return true;
+            }
+            i -= this->left;
+            long inner = this->num_slots - this->left - this->right;
+            if (i < inner) {
+                edge.start_node = 1 + random.below(this->left);
+                edge.end_node = 1 + this->left + random.below(this->right);
+                return true;
+            }
+            i -= inner;
+            edge.start_node = 1 + this->left + i;
+            edge.end_node = n - 1;
+            return true;
+        }
+
+        static void appendNumber(string &buffer, long value, char separator) {
+            char digits[24];
+            char *end = to_chars(digits, digits + sizeof(digits) - 1, value).ptr;
+            *end++ = separator;
+            buffer.append(digits, end - digits);
+        }
+
+        // writes the text of the slots [first, last) to the buffer
+        long generateChunk(long first, long last, uint64_t stream, string &buffer) {
+            Random random(this->params.seed, stream);
+            generated_edge_t edge;
+            long count = 0;
+            buffer.clear();
+            for (long i = first; i < last; i++) {
+                if (!slot(i, random, edge))
+                    continue;
+                appendNumber(buffer, edge.start_node, ' ');
+                appendNumber(buffer, edge.end_node, ' ');
+                appendNumber(buffer, edge.capacity, '\n');
+                count++;
+            }
+            return count;
+        }
+
+    public:
+        GraphGenerator(generator_params_t params) : params(params) {
+            long n = max(2L, params.nodes);
+            long m = max(1L, params.edges);
+            this->width = this->degree = this->left = this->right = this->rows = this->cols = 0;
+
+            if (params.family == "layered") {
+                if (this->params.layers <= 0)
+                    this->params.layers = max(1L, (long)sqrt((double)n));
+                long layers = this->params.layers;
+                this->width = max(1L, (n - 2) / layers);
+                this->degree = max(1L, min(this->width, m / max(1L, layers * this->width)));
+                this->num_nodes = 2 + layers * this->width;
+                this->num_slots = 2 * this->width + (layers - 1) * this->width * this->degree;
+            }
+            else if (params.family == "grid") {
+                this->rows = max(1L, (long)sqrt((double)(n - 2)));
+                this->cols = max(1L, (n - 2) / this->rows);
+                this->num_nodes = 2 + this->rows * this->cols;
+                this->num_slots = 4 * this->rows * this->cols + 2 * this->rows;
+            }
+            else if (params.family == "bipartite") {
+                this->left = max(1L, (n - 2) / 2);
+                this->right = max(1L, n - 2 - this->left);
+                this->num_nodes = 2 + this->left + this->right;
+                this->num_slots = this->left + this->right + max(1L, m - this->left - this->right);
+            }
+            else {
+                this->num_nodes = n;
+                this->num_slots = m;
+            }
+        }
+
+        static bool isFamily(const string &family) {
+            return family == "dag" || family == "layered" || family == "grid" || family == "powerlaw" || family == "bipartite";
+        }
+
+        long getNumNodes() {
+            return this->num_nodes;
+        }
+
+        /**
+         * Writes the graph in the input format. The slots are split in chunks, generated by the threads
+         * a round at a time and written in order, so the file only depends on the parameters and the seed.
+         * @param num_threads threads generating the chunks, 0 means hardware concurrency
+         * @return the number of edges written
+         */
+        long write(FILE *out, int num_threads = 0) {
+            if (num_threads <= 0)
+                num_threads = std::thread::hardware_concurrency();
+            num_threads = max(1, num_threads);
+
+            fprintf(out, "%ld\n", this->num_nodes);
+            long num_chunks = (this->num_slots + CHUNK_SLOTS - 1) / CHUNK_SLOTS;
+            vector<string> buffers(num_threads);
+            vector<long> counts(num_threads);
+            long written = 0;
+
+            for (long round = 0; round < num_chunks; round += num_threads) {
+                int tasks = (int)min((long)num_threads, num_chunks - round);
+                vector<thread> workers;
+                for (int k = 0; k < tasks; k++) {
+                    workers.emplace_back([this, &buffers, &counts, round, k] {
+                        long chunk = round + k;
+                        long first = chunk * CHUNK_SLOTS;
+                        long last = min(this->num_slots, first + CHUNK_SLOTS);
+                        counts[k] = generateChunk(first, last, chunk, buffers[k]);
+                    });
+                }
+                for (int k = 0; k < tasks; k++) {
+                    workers[k].join();
+                    fwrite(buffers[k].data(), 1, buffers[k].size(), out);
+                    written += counts[k];
+                }
+            }
+            return written;
+        }
+};
@@ -0,0 +1,94 @@
+// Header file that contains the pre-solve pruning pass
+// Nodes that are not on any s-t path can never carry flow: they are dropped before solving
+// and the remaining nodes get compact ids, so that every per-node array shrinks too.
+#pragma once
+
+#include <list>
+#include <vector>
+
+#include "Edge.hpp"
+
+using namespace std;
+
+// an edge of the input file with its original node ids (edge is nullptr when it was pruned)
+typedef struct {
+    int start_node;
+    int end_node;
+    Edge *edge;
+} output_edge_t;
+
+/**
+ * Finds the nodes that lie on some s-t path, i.e. that are reachable from s (forward BFS over the
+ * edges with capacity) and co-reachable to t (reverse BFS, walking the residual edge stored in
+ * graph[v] for every edge entering v). Must be called before any flow is pushed.
+ * @return the compact id of every node, -1 for the nodes to drop (s and t are always kept)
+ */
+inline vector<int> computeCompactIds(vector<list<Edge *>> &graph, int s, int t) {
+    int n = graph.size();
+    vector<char> from_s(n, 0), to_t(n, 0);
+    vector<int> queue;
+
+    queue.push_back(s);
+    from_s[s] = 1;
+    for (size_t i = 0; i < queue.size(); i++) {
+        for (Edge *edge : graph[queue[i]]) {
+            int next_node = edge->getEndNode();
+            if (!edge->isResidual() && !from_s[next_node]) {
+                from_s[next_node] = 1;
+                queue.push_back(next_node);
+            }
+        }
+    }
+
+    queue.clear();
+    queue.push_back(t);
+    to_t[t] = 1;
+    for (size_t i = 0; i < queue.size(); i++) {
+        for (Edge *edge : graph[queue[i]]) {
+            int prev_node = edge->getEndNode();
+            if (edge->isResidual() && !edge->getResidual()->isResidual() && !to_t[prev_node]) {
+                to_t[prev_node] = 1;
+                queue.push_back(prev_node);
+            }
+        }
+    }
+
+    vector<int> compact_id(n, -1);
+    int next_id = 0;
+    for (int i = 0; i < n; i++) {
+        if ((from_s[i] && to_t[i]) || i == s || i == t)
+            compact_id[i] = next_id++;
+    }
+    return compact_id;
+}
+
+/**
+ * Builds the graph induced by the kept nodes, relabeling the edges with the compact ids.
+ * The edges that touch a dropped node are deleted, together with their residual edge.
+ * @param num_kept the number of nodes with a compact id
+ */
+inline vector<list<Edge *>> compactGraph(vector<list<Edge *>> &graph, const vector<int> &compact_id, int num_kept) {
+    vector<list<Edge *>> compact(num_kept);
+    vector<Edge *> dropped;
+    for (size_t i = 0; i < graph.size(); i++) {
+        for (Edge *edge : graph[i]) {
+            int u = compact_id[edge->getStartNode()];
+            int v = compact_id[edge->getEndNode()];
+            if (u != -1 && v != -1)
+                compact[u].push_back(edge);
+            else
+                dropped.push_back(edge);
+        }
+    }
+    // every edge is in exactly one list, so each one is deleted once
+    for (Edge *edge : dropped) {
+        delete edge;
+    }
+    // relabel only once every edge has been looked at with its old ids
+    for (auto &node_edges : compact) {
+        for (Edge *edge : node_edges) {
+            edge->setNodes(compact_id[edge->getStartNode()], compact_id[edge->getEndNode()]);
+        }
+    }
+    return compact;
+}
@@ -0,0 +1,440 @@
+// Header file that contains the readers of the input files
+// Two formats are accepted, told apart by their first character:
+//  - the format of inputs/: "n" then one "node1 node2 capacity" line per edge, source 0 and sink n-1
+//  - the DIMACS max-flow format: "p max n m", "n id s", "n id t", one "a u v capacity" line per edge,
+//    "c" comment lines, with ids from 1 to n
+// The path "-" reads the standard input, and a pipe (e.g. a FIFO or /dev/fd/N) is parsed as its bytes arrive.
+// Either format can be gzip-compressed: it is told apart by its first two bytes and inflated on the fly.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <climits>
+#include <cerrno>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <zlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+// the edges of an input file, read once before the graph is built
+typedef struct {
+    uint64_t n;
+    vector<uint64_t> tails;
+    vector<uint64_t> heads;
+    vector<uint64_t> capacities;
+    long source;        // terminals given by the file (DIMACS), -1 means node 0 and node n-1
+    long sink;
+    bool loaded;
+} edge_list_t;
+
+// source of the file: the one given by the file, or node 0
+inline long edgeListSource(const edge_list_t &edges) {
+    return edges.source >= 0 ? edges.source : 0;
+}
+
+// sink of the file: the one given by the file, or node n-1
+inline long edgeListSink(const edge_list_t &edges) {
+    return edges.sink >= 0 ? edges.sink : (long)edges.n - 1;
+}
+
+// whether every end node and terminal of the edges is a node id below n
+inline bool edgeListInRange(const edge_list_t &edges) {
+    for (size_t i = 0; i < edges.tails.size(); i++) {
+        if (edges.tails[i] >= edges.n || edges.heads[i] >= edges.n)
+            return false;
+    }
+    return edgeListSource(edges) < (long)edges.n && edgeListSink(edges) < (long)edges.n;
+}
+
+// reads up to 'capacity' bytes, 0 at the end of the file or on an error
+inline size_t readBytes(int fd, char *buffer, size_t capacity) {
+    ssize_t count;
+    do {
+        count = read(fd, buffer, capacity);
+    } while (count < 0 && errno == EINTR);
+    return count > 0 ? count : 0;
+}
+
+// the first two bytes of every gzip member
+inline bool isGzip(const char *bytes, size_t size) {
+    return size >= 2 && (unsigned char)bytes[0] == 0x1f && (unsigned char)bytes[1] == 0x8b;
+}
+
+/**
+ * Inflates a gzip file in its own thread: the blocks of decompressed bytes go through a bounded
+ * queue to the parser, so the next block is inflated while the current one is parsed, and no
+ * decompressed copy of the file is ever written. The parsed blocks come back to be filled again.
+ */
+class GzipStage {
+    private:
+        static const size_t BLOCK_SIZE = 1 << 20;
+        static const size_t QUEUE_BLOCKS = 4;
+
+        int fd;
+        vector<char> input;
+        size_t input_size;
+
+        mutex queue_mutex;
+        condition_variable queue_cv;
+        deque<vector<char>> full_blocks;
+        vector<vector<char>> free_blocks;
+        bool finished, stopped, failed;
+
+        thread worker;
+
+        // takes a parsed block back, or a new one, false if the parser stopped
+        bool takeFreeBlock(vector<char> &block) {
+            unique_lock<mutex> lock(this->queue_mutex);
+            this->queue_cv.wait(lock, [this] { return this->stopped || this->full_blocks.size() < QUEUE_BLOCKS; });
+            if (this->stopped)
+                return false;
+            if (!this->free_blocks.empty()) {
+                block.swap(this->free_blocks.back());
+                this->free_blocks.pop_back();
+            }
+            return true;
+        }
+
+        void pushBlock(vector<char> &block) {
+            lock_guard<mutex> lock(this->queue_mutex);
+            this->full_blocks.push_back(std::move(block));
+            this->queue_cv.notify_all();
+        }
+
+        void inflateFile() {
+            z_stream stream = {};
+            // 16 + MAX_WBITS: gzip header and trailer
+            bool ok = inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK;
+            stream.next_in = (Bytef *)this->input.data();
+            stream.avail_in = this->input_size;
+            bool end_of_file = false;
+            vector<char> block;
+            while (ok && !end_of_file && takeFreeBlock(block)) {
+                block.resize(BLOCK_SIZE);
+                stream.next_out = (Bytef *)block.data();
+                stream.avail_out = BLOCK_SIZE;
+                while (stream.avail_out > 0) {
+                    if (stream.avail_in == 0) {
+                        stream.avail_in = readBytes(this->fd, this->input.data(), this->input.size());
+                        stream.next_in = (Bytef *)this->input.data();
+                        if (stream.avail_in == 0) {
+                            end_of_file = true;
+                            break;
+                        }
+                    }
+                    int status = inflate(&stream, Z_NO_FLUSH);
+                    if (status == Z_STREAM_END) {
+                        // gzip files can be made of several members, one after the other
+                        ok = inflateReset(&stream) == Z_OK;
+                    }
+                    else if (status != Z_OK && status != Z_BUF_ERROR) {
+                        std::cerr << "gzip: " << (stream.msg ? stream.msg : "corrupt input") << std::endl;
+                        ok = false;
+                    }
+                    if (!ok)
+                        break;
+                }
+                block.resize(BLOCK_SIZE - stream.avail_out);
+                if (!block.empty())
+                    pushBlock(block);
+            }
+            // a file that stops inside a member is truncated
+            if (ok && end_of_file && stream.total_in > 0) {
+                std::cerr << "gzip: unexpected end of file" << std::endl;
+                ok = false;
+            }
+            inflateEnd(&stream);
+
+            lock_guard<mutex> lock(this->queue_mutex);
+            this->failed = !ok;
+            this->finished = true;
+            this->queue_cv.notify_all();
+        }
+
+    public:
+        /**
+         * GzipStage constructor, starts the thread
+         * @param first_bytes bytes already read from the file (at least the gzip header)
+         */
+        GzipStage(int fd, const char *first_bytes, size_t size) :
+            fd(fd), input(BLOCK_SIZE), input_size(size), finished(false), stopped(false), failed(false) {
+            copy(first_bytes, first_bytes + size, this->input.begin());
+            this->worker = thread(&GzipStage::inflateFile, this);
+        }
+
+        ~GzipStage() {
+            {
+                lock_guard<mutex> lock(this->queue_mutex);
+                this->stopped = true;
+                this->queue_cv.notify_all();
+            }
+            this->worker.join();
+        }
+
+        /**
+         * Swaps the next block of decompressed bytes into 'buffer', whose bytes are given back.
+         * @return size of the block, 0 at the end of the file or on an error
+         */
+        size_t next(vector<char> &buffer) {
+            unique_lock<mutex> lock(this->queue_mutex);
+            this->queue_cv.wait(lock, [this] { return this->finished || !this->full_blocks.empty(); });
+            if (this->full_blocks.empty())
+                return 0;
+            buffer.swap(this->full_blocks.front());
+            this->free_blocks.push_back(std::move(this->full_blocks.front()));
+            this->full_blocks.pop_front();
+            this->queue_cv.notify_all();
+            return buffer.size();
+        }
+
+        bool hasFailed() {
+            lock_guard<mutex> lock(this->queue_mutex);
+            return this->failed;
+        }
+};
+
+// Reads a file through a large buffer and parses the numbers by hand, without a string per line.
+// read() returns the bytes already available, so the edges of a pipe are parsed while the
+// producer is still writing, instead of after the whole file is there.
+class InputScanner {
+    private:
+        static const size_t BUFFER_SIZE = 1 << 20;
+
+        int fd;
+        vector<char> buffer;
+        size_t position, size;
+        bool started;
+
+        // set by the first fill() if the file is gzip-compressed
+        unique_ptr<GzipStage> gzip;
+
+        bool fill() {
+            this->position = 0;
+            if (this->gzip) {
+                this->size = this->gzip->next(this->buffer);
+                return this->size > 0;
+            }
+            this->size = readBytes(this->fd, this->buffer.data(), BUFFER_SIZE);
+            if (!this->started) {
+                this->started = true;
+                // a pipe can return a single byte, the two bytes of the gzip magic are needed
+                if (this->size == 1)
+                    this->size += readBytes(this->fd, this->buffer.data() + 1, BUFFER_SIZE - 1);
+                if (isGzip(this->buffer.data(), this->size)) {
+                    this->gzip = unique_ptr<GzipStage>(new GzipStage(this->fd, this->buffer.data(), this->size));
+                    this->size = this->gzip->next(this->buffer);
+                }
+            }
+            return this->size > 0;
+        }
+
+    public:
+        InputScanner(int fd) : fd(fd), buffer(BUFFER_SIZE), position(0), size(0), started(false) {}
+
+        // whether the file is gzip-compressed and could not be inflated to its end
+        bool hasFailed() {
+            return this->gzip && this->gzip->hasFailed();
+        }
+
+        // next byte, or EOF at the end of the file
+        int peek() {
+            if (this->position == this->size && !fill())
+                return EOF;
+            return (unsigned char)this->buffer[this->position];
+        }
+
+        int get() {
+            int c = peek();
+            if (c != EOF)
+                this->position++;
+            return c;
+        }
+
+        // skips spaces and tabs, but not the end of the line
+        void skipBlanks() {
+            for (int c = peek(); c == ' ' || c == '\t' || c == '\r'; c = peek())
+                this->position++;
+        }
+
+        // skips spaces, tabs and empty lines
+        void skipSpaces() {
+            for (int c = peek(); c == ' ' || c == '\t' || c == '\r' || c == '\n'; c = peek())
+                this->position++;
+        }
+
+        // skips the rest of the line, end of line included
+        void skipLine() {
+            for (int c = get(); c != '\n' && c != EOF; c = get()) {}
+        }
+
+        // reads a non-negative number after the blanks, false if there is none or if it is above UINT64_MAX
+        bool readNumber(uint64_t &value) {
+            skipBlanks();
+            int c = peek();
+            if (c < '0' || c > '9')
+                return false;
+            value = 0;
+            bool overflow = false;
+            for (; c >= '0' && c <= '9'; c = peek()) {
+                uint64_t digit = c - '0';
+                if (value > (UINT64_MAX - digit) / 10)
+                    overflow = true;
+                value = value * 10 + digit;
+                this->position++;
+            }
+            return !overflow;
+        }
+
+        // reads a word (e.g. "max") after the blanks
+        string readWord() {
+            skipBlanks();
+            string word;
+            for (int c = peek(); c != EOF && c != ' ' && c != '\t' && c != '\r' && c != '\n'; c = peek()) {
+                word.push_back((char)c);
+                this->position++;
+            }
+            return word;
+        }
+};
+
+// the Edge based solvers and the checker hold capacities and flows in a long
+const uint64_t MAX_EDGE_CAPACITY = LONG_MAX;
+
+// the format of inputs/: the number of nodes, then "node1 node2 capacity" triples
+inline bool readPlainEdges(InputScanner &scanner, edge_list_t &edges) {
+    scanner.skipSpaces();
+    if (!scanner.readNumber(edges.n))
+        return false;
+    // the source is node 0 and the sink node n-1
+    if (edges.n < 2) {
+        std::cerr << "The network needs at least 2 nodes, a source and a sink" << std::endl;
+        return false;
+    }
+    uint64_t tail, head, capacity;
+    for (scanner.skipSpaces(); scanner.peek() != EOF; scanner.skipSpaces()) {
+        if (!scanner.readNumber(tail) || !scanner.readNumber(head) || !scanner.readNumber(capacity)) {
+            std::cerr << "Malformed edge after " << edges.tails.size() << " edges" << std::endl;
+            return false;
+        }
+        if (capacity > MAX_EDGE_CAPACITY) {
+            std::cerr << "Malformed edge after " << edges.tails.size() << " edges: capacity " << capacity
+                      << " is above " << MAX_EDGE_CAPACITY << std::endl;
+            return false;
+        }
+        if (tail >= edges.n || head >= edges.n) {
+            std::cerr << "Edge " << tail << " " << head << " after " << edges.tails.size()
+                      << " edges has a node out of range (" << edges.n << " nodes)" << std::endl;
+            return false;
+        }
+        edges.tails.push_back(tail);
+        edges.heads.push_back(head);
+        edges.capacities.push_back(capacity);
+    }
+    return true;
+}
+
+// the DIMACS max-flow format, the ids are turned into 0-based ones
+inline bool readDimacsEdges(InputScanner &scanner, edge_list_t &edges) {
+    bool has_problem = false;
+    uint64_t line_number = 0;
+    for (scanner.skipSpaces(); scanner.peek() != EOF; scanner.skipSpaces()) {
+        line_number++;
+        int kind = scanner.get();
+        uint64_t id, tail, head, capacity, m;
+        if (kind == 'c') {
+            scanner.skipLine();
+            continue;
+        }
+        if (kind == 'p') {
+            if (scanner.readWord() != "max" || !scanner.readNumber(edges.n) || !scanner.readNumber(m)) {
+                std::cerr << "DIMACS: expected \"p max n m\" at line " << line_number << std::endl;
+                return false;
+            }
+            edges.tails.reserve(m);
+            edges.heads.reserve(m);
+            edges.capacities.reserve(m);
+            has_problem = true;
+        }
+        else if (!has_problem) {
+            std::cerr << "DIMACS: the \"p max\" line must come first, line " << line_number << std::endl;
+            return false;
+        }
+        else if (kind == 'n') {
+            string role;
+            if (!scanner.readNumber(id) || id < 1 || id > edges.n || ((role = scanner.readWord()) != "s" && role != "t")) {
+                std::cerr << "DIMACS: expected \"n id s\" or \"n id t\" at line " << line_number << std::endl;
+                return false;
+            }
+            (role == "s" ? edges.source : edges.sink) = id - 1;
+        }
+        else if (kind == 'a') {
+            if (!scanner.readNumber(tail) || !scanner.readNumber(head) || !scanner.readNumber(capacity) ||
+                tail < 1 || tail > edges.n || head < 1 || head > edges.n) {
+                std::cerr << "DIMACS: malformed arc at line " << line_number << std::endl;
+                return false;
+            }
+            if (capacity > MAX_EDGE_CAPACITY) {
+                std::cerr << "DIMACS: malformed arc at line " << line_number << ": capacity " << capacity
+                          << " is above " << MAX_EDGE_CAPACITY << std::endl;
+                return false;
+            }
+            edges.tails.push_back(tail - 1);
+            edges.heads.push_back(head - 1);
+            edges.capacities.push_back(capacity);
+        }
+        else {
+            std::cerr << "DIMACS: unknown line \"" << (char)kind << "\" at line " << line_number << std::endl;
+            return false;
+        }
+        scanner.skipLine();
+    }
+    if (!has_problem || edges.source < 0 || edges.sink < 0) {
+        std::cerr << "DIMACS: the \"p max\" line, the source and the sink are required" << std::endl;
+        return false;
+    }
+    if (edges.source == edges.sink) {
+        std::cerr << "DIMACS: node " << edges.source + 1 << " cannot be both the source and the sink" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// reads the edges of an open file descriptor in either format, compressed or not
+inline edge_list_t readEdgeList(int fd) {
+    edge_list_t edges = {0, {}, {}, {}, -1, -1, false};
+    InputScanner scanner(fd);
+    scanner.skipSpaces();
+    int first = scanner.peek();
+    edges.loaded = (first == 'c' || first == 'p') ? readDimacsEdges(scanner, edges) : readPlainEdges(scanner, edges);
+    edges.loaded = edges.loaded && !scanner.hasFailed();
+    return edges;
+}
+
+/**
+ * Reads the edges of a file in either format.
+ * @param input_file_path path of a file or a pipe, "-" for the standard input
+ * @return the edges, with loaded false if the file cannot be read
+ */
+inline edge_list_t readEdgeList(string input_file_path) {
+    bool is_stdin = input_file_path == "-";
+    int fd = is_stdin ? STDIN_FILENO : open(input_file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << input_file_path << std::endl;
+        return {0, {}, {}, {}, -1, -1, false};
+    }
+    edge_list_t edges = readEdgeList(fd);
+    if (!is_stdin)
+        close(fd);
+    return edges;
+}
@@ -0,0 +1,236 @@
+// Header file that contains class GraphSimplifier
+// Reduces the graph before solving (parallel edges merged, simple chains contracted) and
+// expands the flow back onto the original edges once the solver is done.
+#pragma once
+
+#include <iostream>
+#include <list>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+
+#include "Edge.hpp"
+
+using namespace std;
+
+class GraphSimplifier {
+    private:
+        // an edge created by the simplification and the edges it stands for
+        typedef struct {
+            Edge *edge;
+            vector<Edge *> parts;
+            bool parallel;      // true: parts are parallel edges, false: parts are the edges of a chain
+        } reduction_t;
+
+        // in creation order, expanded in reverse order since a part can be a reduced edge itself
+        vector<reduction_t> reductions;
+
+        // the graph given to simplify(), restored by expand()
+        vector<list<Edge *>> original_graph;
+
+        int num_merged = 0;
+        int num_contracted = 0;
+
+        // creates an edge and its residual edge
+        Edge *newEdge(int start_node, int end_node, long capacity) {
+            Edge *edge = new Edge(start_node, end_node, capacity);
+            Edge *edge_residual = new Edge(end_node, start_node, 0);
+            edge->setResidual(edge_residual);
+            edge_residual->setResidual(edge);
+            return edge;
+        }
+
+        // check if the only edges of a node are one incoming and one outgoing edge
+        bool isChainNode(vector<list<Edge *>> &graph, int node, int s, int t) {
+            if (node == s || node == t || graph[node].size() != 2)
+                return false;
+            return inEdge(graph, node) != nullptr && outEdge(graph, node) != nullptr;
+        }
+
+        Edge *inEdge(vector<list<Edge *>> &graph, int node) {
+            for (Edge *edge : graph[node]) {
+                if (edge->isResidual() && !edge->getResidual()->isResidual())
+                    return edge->getResidual();
+            }
+            return nullptr;
+        }
+
+        Edge *outEdge(vector<list<Edge *>> &graph, int node) {
+            for (Edge *edge : graph[node]) {
+                if (!edge->isResidual())
+                    return edge;
+            }
+            return nullptr;
+        }
+
+        /* Replaces every group of parallel edges u -> v with one edge whose capacity is the sum of
+        their capacities, placed where the first edge of the group was. */
+        bool mergeParallelEdges(vector<list<Edge *>> &graph) {
+            int n = graph.size();
+            vector<int> group(n, -1);   // group of the edges u -> v, for the current u
+            unordered_set<Edge *> replaced;
+            vector<Edge *> new_residuals;
+
+            for (int u = 0; u < n; u++) {
+                vector<vector<Edge *>> groups;
+                for (Edge *edge : graph[u]) {
+                    if (edge->isResidual())
+                        continue;
+                    int v = edge->getEndNode();
+                    if (group[v] == -1) {
+                        group[v] = groups.size();
+                        groups.push_back(vector<Edge *>());
+                    }
+                    groups[group[v]].push_back(edge);
+                }
+
+                list<Edge *> node_edges;
+                for (Edge *edge : graph[u]) {
+                    if (edge->isResidual()) {
+                        node_edges.push_back(edge);
+                        continue;
+                    }
+                    vector<Edge *> &parts = groups[group[edge->getEndNode()]];
+                    if (parts.size() == 1) {
+                        node_edges.push_back(edge);
+                    }
+                    else if (parts[0] == edge) {
+                        long capacity = 0;
+                        for (Edge *part : parts) {
+                            capacity += part->getCapacity();
+                            replaced.insert(part);
+                        }
+                        Edge *merged = newEdge(u, edge->getEndNode(), capacity);
+                        node_edges.push_back(merged);
+                        new_residuals.push_back(merged->getResidual());
+                        this->reductions.push_back({merged, parts, true});
+                        this->num_merged += parts.size() - 1;
+                    }
+                }
+                graph[u] = node_edges;
+
+                for (vector<Edge *> &parts : groups) {
+                    group[parts[0]->getEndNode()] = -1;
+                }
+            }
+
+            if (replaced.empty())
+                return false;
+
+            // the residual edges of the merged edges are replaced by the one of the new edge
+            for (int v = 0; v < n; v++) {
+                graph[v].remove_if([&replaced](Edge *edge) {
+                    return edge->isResidual() && replaced.count(edge->getResidual()) > 0;
+                });
+            }
+            for (Edge *edge_residual : new_residuals) {
+                graph[edge_residual->getStartNode()].push_back(edge_residual);
+            }
+            return true;
+        }
+
+        /* Replaces every maximal chain w -> x1 -> ... -> xk -> y, where each xi only has one incoming
+        and one outgoing edge, with one edge w -> y whose capacity is the minimum along the chain. */
+        bool contractChains(vector<list<Edge *>> &graph, int s, int t) {
+            int n = graph.size();
+            vector<char> seen(n, 0);
+            bool changed = false;
+
+            for (int x = 0; x < n; x++) {
+                if (seen[x] || !isChainNode(graph, x, s, t))
+                    continue;
+
+                // walk back to the first node of the chain (or around a cycle of chain nodes)
+                int first = x;
+                bool cycle = false;
+                while (true) {
+                    int prev = inEdge(graph, first)->getStartNode();
+                    if (!isChainNode(graph, prev, s, t))
+                        break;
+                    if (prev == x) {
+                        cycle = true;
+                        break;
+                    }
+                    first = prev;
+                }
+
+                vector<Edge *> parts;
+                parts.push_back(inEdge(graph, first));
+                int node = first;
+                while (isChainNode(graph, node, s, t) && !seen[node]) {
+                    seen[node] = 1;
+                    parts.push_back(outEdge(graph, node));
+                    node = parts.back()->getEndNode();
+                }
+
+                int w = parts.front()->getStartNode();
+                int y = parts.back()->getEndNode();
+                if (cycle || w == y)
+                    continue;
+
+                long capacity = parts[0]->getCapacity();
+                for (Edge *part : parts) {
+                    capacity = min(capacity, part->getCapacity());
+                }
+                Edge *contracted = newEdge(w, y, capacity);
+                replace(graph[w].begin(), graph[w].end(), parts.front(), contracted);
+                replace(graph[y].begin(), graph[y].end(), parts.back()->getResidual(), contracted->getResidual());
+                for (size_t i = 1; i < parts.size(); i++) {
+                    graph[parts[i]->getStartNode()].clear();
+                }
+
+                this->reductions.push_back({contracted, parts, false});
+                this->num_contracted += parts.size() - 1;
+                changed = true;
+            }
+            return changed;
+        }
+
+    public:
+        /**
+         * Simplifies the graph until no parallel edges and no chains are left.
+         * The graph given is saved and is restored by expand().
+         * @return the simplified graph, with the same node ids (contracted nodes are left without edges)
+         */
+        vector<list<Edge *>> simplify(const vector<list<Edge *>> &graph, int s, int t) {
+            this->original_graph = graph;
+            vector<list<Edge *>> simplified = graph;
+
+            bool changed = true;
+            while (changed) {
+                changed = mergeParallelEdges(simplified);
+                changed = contractChains(simplified, s, t) || changed;
+            }
+            cout << "Simplified graph: merged " << this->num_merged << " parallel edges, contracted "
+                 << this->num_contracted << " chain nodes" << endl;
+            return simplified;
+        }
+
+        /**
+         * Moves the flow of every reduced edge back onto the edges it stands for, frees the reduced
+         * edges and returns the original graph. The flow of a merged edge is given to its parts in
+         * order, each one up to its capacity; every edge of a chain carries the flow of the chain.
+         */
+        vector<list<Edge *>> expand() {
+            for (auto it = this->reductions.rbegin(); it != this->reductions.rend(); it++) {
+                long flow = it->edge->getFlow();
+                for (Edge *part : it->parts) {
+                    if (it->parallel) {
+                        long part_flow = min(flow, part->getCapacity());
+                        part->setFlow(part_flow);
+                        flow -= part_flow;
+                    }
+                    else {
+                        part->setFlow(flow);
+                    }
+                }
+            }
+
+            for (reduction_t &reduction : this->reductions) {
+                delete reduction.edge->getResidual();
+                delete reduction.edge;
+            }
+            this->reductions.clear();
+            return this->original_graph;
+        }
+};
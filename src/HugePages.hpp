@@ -0,0 +1,81 @@
+// Header file that contains class HugePageAllocator
+// Allocator of the large graph arrays: when huge pages are turned on, a block of 1 MB or more is
+// rounded up and aligned to 2 MB and marked with madvise(MADV_HUGEPAGE), so that the kernel backs it with
+// transparent huge pages and a random access in the array rarely misses the TLB.
+#pragma once
+
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+
+using namespace std;
+
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// smaller blocks keep normal pages, a huge page would at least double them
+const size_t HUGE_PAGE_MIN_BYTES = HUGE_PAGE_SIZE / 2;
+
+// huge pages are opt-in: the allocations made before turning them on keep normal pages
+inline bool &hugePagesFlag() {
+    static bool enabled = false;
+    return enabled;
+}
+
+inline void setHugePages(bool enabled) {
+    hugePagesFlag() = enabled;
+}
+
+inline bool hugePagesEnabled() {
+    return hugePagesFlag();
+}
+
+template <typename T>
+class HugePageAllocator {
+    public:
+        typedef T value_type;
+
+        HugePageAllocator() {}
+
+        template <typename U>
+        HugePageAllocator(const HugePageAllocator<U> &) {}
+
+        T *allocate(size_t count) {
+            size_t bytes = count * sizeof(T);
+            void *block;
+            if (hugePagesEnabled() && bytes >= HUGE_PAGE_MIN_BYTES) {
+                // aligned_alloc wants a multiple of the alignment
+                bytes = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+                block = aligned_alloc(HUGE_PAGE_SIZE, bytes);
+                // only a hint: without THP support (or with THP "never") the block keeps normal pages
+                if (block != nullptr)
+                    madvise(block, bytes, MADV_HUGEPAGE);
+            }
+            else {
+                block = malloc(bytes > 0 ? bytes : 1);
+            }
+            if (block == nullptr)
+                throw bad_alloc();
+            return static_cast<T *>(block);
+        }
+
+        // both kinds of blocks come from the C allocator
+        void deallocate(T *block, size_t) {
+            free(block);
+        }
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &) {
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &) {
+    return false;
+}
+
+// a vector that goes on huge pages when they are turned on
+template <typename T>
+using huge_vector = vector<T, HugePageAllocator<T>>;
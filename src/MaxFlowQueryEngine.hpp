@@ -0,0 +1,483 @@
+// Header file that contains the engine answering many s-t max flow queries on one network
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+#include "FlowNetwork.hpp"
+#include "ArcScan.hpp"
+#include "VertexOrdering.hpp"
+#include "SharedGraphStore.hpp"
+
+using namespace std;
+
+// an edge of a min cut, with the ids of the input file
+typedef struct {
+    long start_node;
+    long end_node;
+    long capacity;
+} cut_edge_t;
+
+/* Templated on the widths of the network. With unsigned capacities the residual flow of an arc
+   (minus the flow of its forward arc) wraps around, but the remaining capacity
+   capacity - flow is still exact, and it is the only value the search compares. */
+template <typename index_t, typename capacity_t>
+class MaxFlowQueryEngine
+{
+private:
+    // topology shared (read-only) by every query
+    const FlowNetworkT<index_t, capacity_t> &network;
+
+    // no path carries more, and FlowNetworkT::fits() bounds every flow by it
+    const capacity_t INF = numeric_limits<capacity_t>::max();
+
+    // a frame of the explicit dfs stack: the node and the next arc to scan
+    typedef struct {
+        index_t node;
+        index_t arc;
+    } frame_t;
+
+    // arcs between the one scanned and the one whose head is prefetched
+    static const index_t PREFETCH_DISTANCE = 8;
+
+    // prefetch the visited flags of the heads of the upcoming arcs (opt-in, see setPrefetch())
+    bool prefetch = false;
+
+    // kernel finding the next admissible arc, the widest one of the CPU by default
+    scan_kernel_t scan_kernel;
+
+    // private state of a worker: residual flows of the query being solved
+    struct Workspace {
+        huge_vector<capacity_t> flow;
+        huge_vector<uint32_t> visited;
+        uint32_t visit_flag = 0;
+        vector<frame_t> stack;
+    };
+
+    // workspaces of the finished solve() calls, reused so that their arrays are already allocated
+    vector<unique_ptr<Workspace>> idle_workspaces;
+    mutex workspace_mutex;
+
+    unique_ptr<Workspace> acquireWorkspace() {
+        lock_guard<mutex> lock(this->workspace_mutex);
+        if (this->idle_workspaces.empty())
+            return unique_ptr<Workspace>(new Workspace());
+        unique_ptr<Workspace> ws = std::move(this->idle_workspaces.back());
+        this->idle_workspaces.pop_back();
+        return ws;
+    }
+
+    void releaseWorkspace(unique_ptr<Workspace> ws) {
+        lock_guard<mutex> lock(this->workspace_mutex);
+        this->idle_workspaces.push_back(std::move(ws));
+    }
+
+public:
+    // constructor
+    MaxFlowQueryEngine(const FlowNetworkT<index_t, capacity_t> &network) : network(network) {
+        setScanKernel(detectScanKernel());
+    }
+
+    /**
+     * Chooses the kernel of the arc scan. The AVX2 gather takes signed 32-bit node ids, so
+     * larger networks fall back to SSE4.1.
+     */
+    void setScanKernel(scan_kernel_t kernel) {
+        if (kernel == SCAN_AVX2 && (uint64_t)this->network.getNumNodes() > (uint64_t)INT32_MAX)
+            kernel = SCAN_SSE4;
+        this->scan_kernel = kernel;
+    }
+
+    scan_kernel_t getScanKernel() const {
+        return this->scan_kernel;
+    }
+
+    /**
+     * Turns on the prefetching traversal: while scanning an arc, the dfs prefetches the visited
+     * flag of the head of the arc PREFETCH_DISTANCE positions ahead, so that the random lookup
+     * is already in cache when the scan reaches it. Every scan kernel prefetches, the vector ones
+     * the heads of the group of 8 arcs after the one they check.
+     */
+    void setPrefetch(bool prefetch) {
+        this->prefetch = prefetch;
+    }
+
+    /**
+     * Solves every (s, t) pair of the batch, in parallel across queries.
+     * @param queries the (source, sink) pairs
+     * @param num_threads workers to use, 0 means hardware concurrency
+     * @return the max flow of each pair, in the same order; -1 for an invalid pair
+     */
+    vector<long> solveBatch(const vector<pair<long, long>> &queries, int num_threads = 0) {
+        vector<long> results(queries.size(), -1);
+        if (queries.empty()) {
+            return results;
+        }
+
+        if (num_threads <= 0) {
+            num_threads = std::thread::hardware_concurrency();
+        }
+        num_threads = max(1, min(num_threads, (int)queries.size()));
+
+        // each worker picks the next unsolved query
+        atomic<int> next_query{0};
+        vector<thread> workers;
+        for (int i = 0; i < num_threads; i++) {
+            workers.emplace_back([this, &queries, &results, &next_query] {
+                Workspace ws;
+                for (int q = next_query.fetch_add(1); q < (int)queries.size(); q = next_query.fetch_add(1)) {
+                    results[q] = solveQuery(ws, queries[q].first, queries[q].second);
+                }
+            });
+        }
+        for (thread &worker : workers) {
+            worker.join();
+        }
+        return results;
+    }
+
+    // solves one (s, t) pair on the calling thread, may be called by several threads at the same time
+    long solve(long s, long t) {
+        unique_ptr<Workspace> ws = acquireWorkspace();
+        long max_flow = solveQuery(*ws, s, t);
+        releaseWorkspace(std::move(ws));
+        return max_flow;
+    }
+
+    /**
+     * Solves one (s, t) pair and finds a min cut: the last search, which does not reach t, has
+     * visited exactly the nodes reachable from s in the residual network.
+     * @param cut_arcs set to the forward arcs from the reachable nodes to the others
+     */
+    long solveCut(long s, long t, vector<index_t> &cut_arcs) {
+        const FlowNetworkT<index_t, capacity_t> &g = this->network;
+        unique_ptr<Workspace> ws = acquireWorkspace();
+        long max_flow = solveQuery(*ws, s, t);
+        cut_arcs.clear();
+        for (index_t u = 0; max_flow >= 0 && u < g.getNumNodes(); u++) {
+            if (ws->visited[u] != ws->visit_flag)
+                continue;
+            for (index_t arc = g.firstArc(u); arc < g.lastArc(u); arc++) {
+                if (g.getCapacity(arc) > 0 && ws->visited[g.getHead(arc)] != ws->visit_flag)
+                    cut_arcs.push_back(arc);
+            }
+        }
+        releaseWorkspace(std::move(ws));
+        return max_flow;
+    }
+
+private:
+    long solveQuery(Workspace &ws, long s, long t) {
+        long n = this->network.getNumNodes();
+        if (s < 0 || t < 0 || s >= n || t >= n || s == t) {
+            std::cerr << "Invalid query: " << s << " " << t << std::endl;
+            return -1;
+        }
+
+        // reset the private residual network
+        ws.flow.assign(this->network.getNumArcs(), 0);
+        ws.visited.assign(n, 0);
+        ws.visit_flag = 0;
+        ws.stack.reserve(n);
+
+        long max_flow = 0;
+        for (capacity_t f = dfs(ws, s, t); f != 0; f = dfs(ws, s, t)) {
+            max_flow += f;
+        }
+        return max_flow;
+    }
+
+    // first arc of [first, last) with remaining capacity towards a node not visited yet, or last
+    index_t nextAdmissibleArc(Workspace &ws, index_t first, index_t last) {
+        const FlowNetworkT<index_t, capacity_t> &g = this->network;
+        index_t distance = this->prefetch ? PREFETCH_DISTANCE : 0;
+        switch (this->scan_kernel) {
+            case SCAN_AVX2:
+                return scanArcsAVX2(g.getHeads(), g.getCapacities(), ws.flow.data(), ws.visited.data(), ws.visit_flag, first, last, distance);
+            case SCAN_SSE4:
+                return scanArcsSSE4(g.getHeads(), g.getCapacities(), ws.flow.data(), ws.visited.data(), ws.visit_flag, first, last, distance);
+            default:
+                return scanArcsScalar(g.getHeads(), g.getCapacities(), ws.flow.data(), ws.visited.data(), ws.visit_flag, first, last, distance);
+        }
+    }
+
+    // finds an augmenting path with an explicit stack, augments it and returns its bottleneck
+    capacity_t dfs(Workspace &ws, index_t s, index_t t) {
+        const FlowNetworkT<index_t, capacity_t> &g = this->network;
+        ws.visit_flag++;
+        ws.stack.clear();
+        ws.stack.push_back({s, g.firstArc(s)});
+        ws.visited[s] = ws.visit_flag;
+
+        while (!ws.stack.empty() && ws.stack.back().node != t) {
+            frame_t &top = ws.stack.back();
+            index_t last = g.lastArc(top.node);
+            index_t arc = nextAdmissibleArc(ws, top.arc, last);
+            if (arc == last) {
+                ws.stack.pop_back();
+                continue;
+            }
+            top.arc = arc + 1;
+            index_t next_node = g.getHead(arc);
+            ws.visited[next_node] = ws.visit_flag;
+            ws.stack.push_back({next_node, g.firstArc(next_node)});
+        }
+        if (ws.stack.empty()) {
+            return 0;
+        }
+
+        // the arc taken out of each frame is the one just before its cursor
+        capacity_t bottleneck = INF;
+        for (size_t i = 0; i + 1 < ws.stack.size(); i++) {
+            index_t arc = ws.stack[i].arc - 1;
+            bottleneck = min(bottleneck, (capacity_t)(g.getCapacity(arc) - ws.flow[arc]));
+        }
+        for (size_t i = 0; i + 1 < ws.stack.size(); i++) {
+            index_t arc = ws.stack[i].arc - 1;
+            ws.flow[arc] += bottleneck;
+            ws.flow[g.getReverse(arc)] -= bottleneck;
+        }
+        return bottleneck;
+    }
+};
+
+// a network loaded with the widths chosen at load time, and its engine, behind one interface
+class QueryEngineBase
+{
+public:
+    virtual ~QueryEngineBase() {}
+    virtual bool isLoaded() = 0;
+    virtual long getNumNodes() = 0;
+    virtual long getNumEdges() = 0;
+    // terminals of the input file (node 0 and node n-1 unless it is in DIMACS format), with its ids
+    virtual long getSource() = 0;
+    virtual long getSink() = 0;
+    virtual size_t getMemoryBytes() = 0;
+    virtual string getWidthName() = 0;
+    virtual vector<long> solveBatch(const vector<pair<long, long>> &queries, int num_threads = 0) = 0;
+    virtual long solve(long s, long t) = 0;
+    virtual long solveCut(long s, long t, vector<cut_edge_t> &cut) = 0;
+    virtual bool setEdgeCapacity(long i, uint64_t capacity) = 0;
+    virtual void setPrefetch(bool prefetch) = 0;
+    virtual void setScanKernel(scan_kernel_t kernel) = 0;
+    virtual string getScanKernelName() = 0;
+    virtual long getOriginalId(long u) = 0;
+    virtual bool createSharedSegment(string name, const shared_graph_source_t &source) = 0;
+    virtual bool isShared() = 0;
+};
+
+template <typename index_t, typename capacity_t>
+class QueryEngineInstance : public QueryEngineBase
+{
+private:
+    // declared before the engine, which keeps a reference to it
+    FlowNetworkT<index_t, capacity_t> network;
+    MaxFlowQueryEngine<index_t, capacity_t> engine;
+    network_width_t width;
+
+    // id in the network of every input node, and the inverse mapping (both empty without reordering)
+    vector<uint64_t> new_id;
+    vector<uint64_t> original_id;
+
+    // the id of an input node in the network, invalid ids are left for the engine to reject
+    long networkId(long u) {
+        if (this->new_id.empty() || u < 0 || u >= (long)this->new_id.size())
+            return u;
+        return this->new_id[u];
+    }
+
+public:
+    QueryEngineInstance(const edge_list_t &edges, network_width_t width, const vector<uint64_t> &new_id = {})
+        : network(edges), engine(network), width(width), new_id(new_id) {
+        this->original_id = invertVertexOrder(new_id);
+    }
+
+    // a network mapped from a shared memory segment, with the ids of the input file
+    QueryEngineInstance(const network_arrays_t<index_t, capacity_t> &arrays, network_width_t width)
+        : network(arrays), engine(network), width(width) {}
+
+    bool isLoaded() { return this->network.isLoaded(); }
+    long getNumNodes() { return this->network.getNumNodes(); }
+    long getNumEdges() { return this->network.getNumEdges(); }
+    long getSource() { return getOriginalId(this->network.getSource()); }
+    long getSink() { return getOriginalId(this->network.getSink()); }
+    size_t getMemoryBytes() { return this->network.getMemoryBytes(); }
+    string getWidthName() { return network_width_names[this->width]; }
+
+    vector<long> solveBatch(const vector<pair<long, long>> &queries, int num_threads = 0) {
+        if (this->new_id.empty())
+            return this->engine.solveBatch(queries, num_threads);
+        vector<pair<long, long>> renamed(queries.size());
+        for (size_t i = 0; i < queries.size(); i++)
+            renamed[i] = {networkId(queries[i].first), networkId(queries[i].second)};
+        return this->engine.solveBatch(renamed, num_threads);
+    }
+
+    long solve(long s, long t) {
+        return this->engine.solve(networkId(s), networkId(t));
+    }
+
+    long solveCut(long s, long t, vector<cut_edge_t> &cut) {
+        vector<index_t> cut_arcs;
+        long max_flow = this->engine.solveCut(networkId(s), networkId(t), cut_arcs);
+        cut.clear();
+        for (index_t arc : cut_arcs) {
+            cut.push_back({getOriginalId(this->network.getTail(arc)), getOriginalId(this->network.getHead(arc)),
+                           (long)this->network.getCapacity(arc)});
+        }
+        return max_flow;
+    }
+
+    // not to be called while queries run on the network
+    bool setEdgeCapacity(long i, uint64_t capacity) {
+        return i >= 0 && i < (long)this->network.getNumEdges() && this->network.setEdgeCapacity(i, capacity);
+    }
+
+    // input id of a node of the network
+    long getOriginalId(long u) {
+        return this->original_id.empty() ? u : this->original_id[u];
+    }
+
+    void setPrefetch(bool prefetch) {
+        this->engine.setPrefetch(prefetch);
+    }
+
+    void setScanKernel(scan_kernel_t kernel) {
+        this->engine.setScanKernel(kernel);
+    }
+
+    string getScanKernelName() {
+        return scan_kernel_names[this->engine.getScanKernel()];
+    }
+
+    // copies the network into a new shared memory segment, the renumbered networks cannot be shared
+    bool createSharedSegment(string name, const shared_graph_source_t &source) {
+        return this->new_id.empty() && createSharedNetwork(name, this->network, source);
+    }
+
+    bool isShared() {
+        return this->network.isShared();
+    }
+};
+
+/**
+ * Reads the input file once and builds the network and the engine with the narrowest widths
+ * that fit its ids and capacities (see chooseNetworkWidth()).
+ * @param width forces the widths if given: a network that does not fit them is not loaded, rather
+ *        than loaded with truncated ids or capacities
+ * @param order renumbers the nodes before the CSR build (see computeVertexOrder()); the queries
+ *        and the results keep the ids of the input file
+ * The arrays of the network go on huge pages if setHugePages(true) was called before.
+ */
+inline unique_ptr<QueryEngineBase> loadQueryEngine(string input_file_path, int width = -1, vertex_order_t order = ORDER_NONE) {
+    edge_list_t edges = readEdgeList(input_file_path);
+    // the vertex order and the CSR build index their arrays by node id
+    if (edges.loaded && !edgeListInRange(edges)) {
+        std::cerr << "The edges of " << input_file_path << " have node ids out of range" << std::endl;
+        edges.loaded = false;
+    }
+    network_width_t chosen = width >= 0 ? (network_width_t)width : chooseNetworkWidth(edges);
+    // even the widest widths are refused when the flows of a query could exceed a long
+    if (edges.loaded && !networkWidthFits(edges, chosen)) {
+        std::cerr << "The ids or capacities of " << input_file_path << " do not fit the widths "
+                  << network_width_names[chosen] << std::endl;
+        edges.loaded = false;
+    }
+    // an engine that is not loaded is returned for the edges that cannot be used
+    // rooted at the source of the file (node 0 unless it is in DIMACS format), where the queries start
+    vector<uint64_t> new_id = computeVertexOrder(edges, order, edges.loaded ? edgeListSource(edges) : 0);
+    relabelEdges(edges, new_id);
+    switch (chosen) {
+        case NETWORK_32_32:
+            return unique_ptr<QueryEngineBase>(new QueryEngineInstance<uint32_t, uint32_t>(edges, chosen, new_id));
+        case NETWORK_32_64:
+            return unique_ptr<QueryEngineBase>(new QueryEngineInstance<uint32_t, uint64_t>(edges, chosen, new_id));
+        default:
+            return unique_ptr<QueryEngineBase>(new QueryEngineInstance<uint64_t, uint64_t>(edges, chosen, new_id));
+    }
+}
+
+// the widths of a segment, as recorded in its header
+inline network_width_t sharedNetworkWidth(const shared_graph_header_t &header) {
+    if (header.index_bytes == 4 && header.capacity_bytes == 4)
+        return NETWORK_32_32;
+    if (header.index_bytes == 4 && header.capacity_bytes == 8)
+        return NETWORK_32_64;
+    return NETWORK_64_64;
+}
+
+/**
+ * Maps the network of a shared memory segment (see SharedGraphStore.hpp) and builds its engine.
+ * @param source the input file the segment must have been built from
+ * @param width the widths the segment must have if given
+ * @param engine set to the engine if the segment is mapped
+ */
+inline shared_graph_status_t attachQueryEngine(string shm_name, const shared_graph_source_t &source, int width,
+                                        unique_ptr<QueryEngineBase> &engine) {
+    shared_graph_header_t header;
+    shared_ptr<void> mapping;
+    shared_graph_status_t status = mapSharedNetwork(shm_name, source, header, mapping);
+    if (status != SHARED_GRAPH_MAPPED)
+        return status;
+    network_width_t chosen = sharedNetworkWidth(header);
+    if (width >= 0 && width != chosen) {
+        std::cerr << "Shared memory " << sharedGraphName(shm_name) << " holds a network of widths " << network_width_names[chosen]
+                  << ", not " << network_width_names[width] << std::endl;
+        return SHARED_GRAPH_UNUSABLE;
+    }
+    switch (chosen) {
+        case NETWORK_32_32:
+            engine.reset(new QueryEngineInstance<uint32_t, uint32_t>(sharedNetworkArrays<uint32_t, uint32_t>(header, mapping), chosen));
+            break;
+        case NETWORK_32_64:
+            engine.reset(new QueryEngineInstance<uint32_t, uint64_t>(sharedNetworkArrays<uint32_t, uint64_t>(header, mapping), chosen));
+            break;
+        default:
+            engine.reset(new QueryEngineInstance<uint64_t, uint64_t>(sharedNetworkArrays<uint64_t, uint64_t>(header, mapping), chosen));
+    }
+    return SHARED_GRAPH_MAPPED;
+}
+
+/**
+ * Uses the network of the shared memory segment 'shm_name', created from the input file by the first
+ * process that needs it: that process reads the file, copies the network into the segment, drops its
+ * own copy and maps the segment like the others. A segment built from another file (or from an older
+ * version of this one), or with other widths than the forced ones, is refused.
+ * @return nullptr if the segment cannot be used
+ */
+inline unique_ptr<QueryEngineBase> loadSharedQueryEngine(string input_file_path, string shm_name, int width = -1) {
+    shared_graph_source_t source;
+    if (!sharedGraphSource(input_file_path, source)) {
+        std::cerr << "Only a regular input file can be shared: " << input_file_path << std::endl;
+        return nullptr;
+    }
+    unique_ptr<QueryEngineBase> engine;
+    shared_graph_status_t status = attachQueryEngine(shm_name, source, width, engine);
+    if (status != SHARED_GRAPH_MISSING)
+        return engine;
+    engine = loadQueryEngine(input_file_path, width);
+    if (!engine->isLoaded())
+        return engine;
+    // another process may create it first, then this copy is simply dropped
+    bool created = engine->createSharedSegment(shm_name, source);
+    if (created)
+        engine.reset();
+    unique_ptr<QueryEngineBase> shared_engine;
+    status = attachQueryEngine(shm_name, source, width, shared_engine);
+    if (status == SHARED_GRAPH_MISSING && engine) {
+        // no segment could be created (e.g. /dev/shm is full): this process keeps its own copy
+        std::cerr << "Shared memory " << sharedGraphName(shm_name) << " could not be created, the network of "
+                  << input_file_path << " is kept in the memory of this process" << std::endl;
+        return engine;
+    }
+    if (status == SHARED_GRAPH_MISSING)
+        std::cerr << "Shared memory " << sharedGraphName(shm_name) << " was removed before it could be mapped" << std::endl;
+    return shared_engine;
+}
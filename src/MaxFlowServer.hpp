@@ -0,0 +1,385 @@
+// Header file that contains class MaxFlowServer
+// A daemon that keeps named networks loaded and a pool of warm threads, and answers the requests of
+// its clients over a Unix domain socket. One request per line, one reply per line:
+//    load name path [none|bfs|rcm|degree]   ok name nodes edges widths
+//    unload name                             ok
+//    update name edge capacity               ok            (edge: index of the edge in the input file)
+//    solve name s t                          ok flow
+//    cut name s t                            ok flow k u1 v1 c1 ... uk vk ck
+//    list                                    ok name1 name2 ...
+//    quit                                    (closes the connection)
+//    shutdown                                ok            (stops the server)
+// or "error message". A client can send many requests without waiting: the solves and cuts run in
+// parallel on the pool, and the replies are written in the order of the requests. A load, unload or
+// update waits for the requests sent before it, and the ones after it wait for it.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <condition_variable>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "MaxFlowQueryEngine.hpp"
+#include "ThreadPool.hpp"
+
+using namespace std;
+
+// a network kept in memory: solves share its lock, a capacity update takes it alone
+typedef struct {
+    unique_ptr<QueryEngineBase> engine;
+    shared_timed_mutex lock;
+} resident_graph_t;
+
+// the reply to a request, written once it and all the replies before it are ready
+typedef struct {
+    string text;
+    bool ready;
+} reply_slot_t;
+
+// a client: its socket, and the replies it is waiting for in the order of its requests
+typedef struct {
+    int fd;
+    mutex reply_mutex;
+    condition_variable replies_written;
+    deque<shared_ptr<reply_slot_t>> replies;
+} connection_t;
+
+class MaxFlowServer
+{
+private:
+    // longest request line, a load line with a path of PATH_MAX bytes fits
+    static const size_t MAX_REQUEST_BYTES = 8192;
+
+    string socket_path;
+    int listen_fd;
+    atomic<bool> stopping{false};
+
+    // threads that run the requests, started once for the life of the server
+    ThreadPool pool;
+    int num_threads;
+
+    mutex graphs_mutex;
+    map<string, shared_ptr<resident_graph_t>> graphs;
+
+    // sockets of the open connections, shut down to stop their readers, which are detached
+    mutex connections_mutex;
+    condition_variable readers_done;
+    set<int> open_fds;
+    int num_readers = 0;
+
+    shared_ptr<resident_graph_t> findGraph(const string &name) {
+        lock_guard<mutex> lock(this->graphs_mutex);
+        auto found = this->graphs.find(name);
+        return found == this->graphs.end() ? nullptr : found->second;
+    }
+
+    // sends all the bytes, false if the client is gone
+    static bool sendAll(int fd, const string &text) {
+        size_t done = 0;
+        while (done < text.size()) {
+            ssize_t count = send(fd, text.data() + done, text.size() - done, MSG_NOSIGNAL);
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0)
+                return false;
+            done += count;
+        }
+        return true;
+    }
+
+    // fills a slot, then writes the replies that are ready at the front of the queue
+    static void completeReply(shared_ptr<connection_t> connection, shared_ptr<reply_slot_t> slot, string text) {
+        lock_guard<mutex> lock(connection->reply_mutex);
+        slot->text = text + "\n";
+        slot->ready = true;
+        string ready_text;
+        while (!connection->replies.empty() && connection->replies.front()->ready) {
+            ready_text += connection->replies.front()->text;
+            connection->replies.pop_front();
+        }
+        sendAll(connection->fd, ready_text);
+        if (connection->replies.empty())
+            connection->replies_written.notify_all();
+    }
+
+    static void waitForReplies(shared_ptr<connection_t> connection) {
+        unique_lock<mutex> lock(connection->reply_mutex);
+        connection->replies_written.wait(lock, [&connection] { return connection->replies.empty(); });
+    }
+
+    string loadGraph(const string &name, const string &path, const string &order_name) {
+        vertex_order_t order = ORDER_NONE;
+        bool known = order_name.empty();
+        for (int k = ORDER_NONE; k <= ORDER_DEGREE; k++) {
+            if (order_name == vertex_order_names[k]) {
+                order = (vertex_order_t)k;
+                known = true;
+            }
+        }
+        if (!known)
+            return "error unknown vertex order " + order_name;
+
+        shared_ptr<resident_graph_t> graph(new resident_graph_t());
+        graph->engine = loadQueryEngine(path, -1, order);
+        if (!graph->engine->isLoaded())
+            return "error failed to load " + path;
+        {
+            // a graph loaded again under the same name replaces the old one, whose running requests keep it alive
+            lock_guard<mutex> lock(this->graphs_mutex);
+            this->graphs[name] = graph;
+        }
+        return "ok " + name + " " + to_string(graph->engine->getNumNodes()) + " " +
+               to_string(graph->engine->getNumEdges()) + " " + graph->engine->getWidthName();
+    }
+
+    // runs one request on a thread of the pool
+    string execute(const string &line) {
+        istringstream words(line);
+        string command, name;
+        words >> command >> name;
+
+        if (command == "list") {
+            lock_guard<mutex> lock(this->graphs_mutex);
+            string reply = "ok";
+            for (const auto &graph : this->graphs)
+                reply += " " + graph.first;
+            return reply;
+        }
+        if (command == "load") {
+            string path, order_name;
+            if (!(words >> path))
+                return "error expected: load name path [order]";
+            words >> order_name;
+            return loadGraph(name, path, order_name);
+        }
+        if (command == "unload") {
+            lock_guard<mutex> lock(this->graphs_mutex);
+            return this->graphs.erase(name) ? "ok" : "error unknown graph " + name;
+        }
+
+        shared_ptr<resident_graph_t> graph = findGraph(name);
+        if (command != "update" && command != "solve" && command != "cut")
+            return "error unknown command " + command;
+        if (!graph)
+            return "error unknown graph " + name;
+
+        if (command == "update") {
+            // the capacity is read as a word: istream would take "-5" as a huge unsigned number
+            long edge;
+            string capacity_word;
+            if (!(words >> edge >> capacity_word) || capacity_word.find_first_not_of("0123456789") != string::npos)
+                return "error expected: update name edge capacity";
+            errno = 0;
+            uint64_t capacity = strtoull(capacity_word.c_str(), nullptr, 10);
+            if (errno == ERANGE)
+                return "error expected: update name edge capacity";
+            unique_lock<shared_timed_mutex> lock(graph->lock);
+            if (!graph->engine->setEdgeCapacity(edge, capacity))
+                return "error edge " + to_string(edge) + " cannot take capacity " + to_string(capacity);
+            return "ok";
+        }
+
+        long s, t;
+        if (!(words >> s >> t))
+            return "error expected: " + command + " name s t";
+        shared_lock<shared_timed_mutex> lock(graph->lock);
+        if (command == "solve") {
+            long max_flow = graph->engine->solve(s, t);
+            return max_flow < 0 ? "error invalid query " + to_string(s) + " " + to_string(t) : "ok " + to_string(max_flow);
+        }
+        vector<cut_edge_t> cut;
+        long max_flow = graph->engine->solveCut(s, t, cut);
+        if (max_flow < 0)
+            return "error invalid query " + to_string(s) + " " + to_string(t);
+        string reply = "ok " + to_string(max_flow) + " " + to_string(cut.size());
+        for (const cut_edge_t &edge : cut)
+            reply += " " + to_string(edge.start_node) + " " + to_string(edge.end_node) + " " + to_string(edge.capacity);
+        return reply;
+    }
+
+    // queues a reply that is known already, in its place among the replies of the client
+    static void queueReply(shared_ptr<connection_t> connection, string text) {
+        shared_ptr<reply_slot_t> slot(new reply_slot_t{"", false});
+        {
+            lock_guard<mutex> lock(connection->reply_mutex);
+            connection->replies.push_back(slot);
+        }
+        completeReply(connection, slot, text);
+    }
+
+    // reads the requests of a client and queues them, until the client closes or quits
+    void serveConnection(int fd) {
+        shared_ptr<connection_t> connection(new connection_t());
+        connection->fd = fd;
+
+        string pending;
+        char buffer[1 << 16];
+        bool open = true;
+        // set after a line longer than MAX_REQUEST_BYTES, which is dropped up to its end
+        bool skipping = false;
+        while (open) {
+            ssize_t count = read(fd, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count <= 0)
+                break;
+            pending.append(buffer, count);
+            if (skipping) {
+                size_t end = pending.find('\n');
+                pending.erase(0, end == string::npos ? pending.size() : end + 1);
+                skipping = end == string::npos;
+            }
+
+            size_t start = 0;
+            for (size_t end = pending.find('\n'); end != string::npos; end = pending.find('\n', start)) {
+                string line = pending.substr(start, end - start);
+                start = end + 1;
+                if (line.size() > MAX_REQUEST_BYTES) {
+                    queueReply(connection, "error request longer than " + to_string(MAX_REQUEST_BYTES) + " bytes");
+                    continue;
+                }
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (line.empty())
+                    continue;
+                if (line == "quit") {
+                    open = false;
+                    break;
+                }
+
+                // the requests that change the graphs keep their place among the requests of the client
+                string command = line.substr(0, line.find(' '));
+                bool barrier = command == "load" || command == "unload" || command == "update";
+                if (barrier)
+                    waitForReplies(connection);
+
+                shared_ptr<reply_slot_t> slot(new reply_slot_t{"", false});
+                {
+                    lock_guard<mutex> lock(connection->reply_mutex);
+                    connection->replies.push_back(slot);
+                }
+                if (line == "shutdown") {
+                    completeReply(connection, slot, "ok");
+                    stop();
+                    open = false;
+                    break;
+                }
+                this->pool.QueueJob([this, connection, slot, line] {
+                    completeReply(connection, slot, execute(line));
+                });
+                if (barrier)
+                    waitForReplies(connection);
+            }
+            pending.erase(0, start);
+            // a client that never ends its line cannot make the buffer grow without limit
+            if (open && pending.size() > MAX_REQUEST_BYTES) {
+                queueReply(connection, "error request longer than " + to_string(MAX_REQUEST_BYTES) + " bytes");
+                pending.clear();
+                skipping = true;
+            }
+        }
+
+        // the socket is closed once the requests still running have replied
+        waitForReplies(connection);
+        close(fd);
+
+        lock_guard<mutex> lock(this->connections_mutex);
+        this->open_fds.erase(fd);
+        this->num_readers--;
+        this->readers_done.notify_all();
+    }
+
+public:
+    /**
+     * MaxFlowServer constructor
+     * @param socket_path path of the Unix domain socket, replaced if it exists
+     * @param num_threads threads of the pool, 0 means hardware concurrency
+     */
+    MaxFlowServer(string socket_path, int num_threads = 0) : socket_path(socket_path), listen_fd(-1) {
+        this->num_threads = num_threads > 0 ? num_threads : max(1u, std::thread::hardware_concurrency());
+    }
+
+    ~MaxFlowServer() {
+        if (this->listen_fd >= 0)
+            close(this->listen_fd);
+    }
+
+    // loads a graph before the first client, as the "load" request
+    string preload(const string &name, const string &path) {
+        return loadGraph(name, path, "");
+    }
+
+    /**
+     * Accepts clients until a "shutdown" request, every client has its own reader thread.
+     * @return false if the socket cannot be created
+     */
+    bool run() {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (this->socket_path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << this->socket_path << std::endl;
+            return false;
+        }
+        copy(this->socket_path.begin(), this->socket_path.end(), address.sun_path);
+        unlink(this->socket_path.c_str());
+
+        this->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (this->listen_fd < 0 || bind(this->listen_fd, (sockaddr *)&address, sizeof(address)) < 0 ||
+            listen(this->listen_fd, 64) < 0) {
+            std::cerr << "Failed to listen on " << this->socket_path << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        this->pool.Start(this->num_threads);
+        cout << "Listening on " << this->socket_path << endl;
+        while (!this->stopping.load()) {
+            int fd = accept(this->listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            lock_guard<mutex> lock(this->connections_mutex);
+            if (this->stopping.load()) {
+                close(fd);
+                break;
+            }
+            this->open_fds.insert(fd);
+            this->num_readers++;
+            thread(&MaxFlowServer::serveConnection, this, fd).detach();
+        }
+
+        {
+            unique_lock<mutex> lock(this->connections_mutex);
+            this->readers_done.wait(lock, [this] { return this->num_readers == 0; });
+        }
+        this->pool.Stop();
+        unlink(this->socket_path.c_str());
+        return true;
+    }
+
+    // stops accepting clients and ends the reads of the open connections, their queued requests still run
+    void stop() {
+        lock_guard<mutex> lock(this->connections_mutex);
+        this->stopping.store(true);
+        ::shutdown(this->listen_fd, SHUT_RDWR);
+        for (int fd : this->open_fds)
+            ::shutdown(fd, SHUT_RD);
+    }
+};
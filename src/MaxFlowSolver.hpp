@@ -1,195 +1,133 @@
 // Header file that contains the Maximum Flow Graph algorithm
 // Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
 
 #include <iostream>
 #include <list>
 #include <vector>
-#include <string>
-#include <fstream>
 
 #include "Edge.hpp"
+#include "MaxFlowSolverBase.hpp"
+#include "ThreadMonitor.hpp"
 
 using namespace std;
 
-class MaxFlowSolver
+class MaxFlowSolver : public MaxFlowSolverBase
 {
 private:
-    // INPUTS
-    //  number of nodes
-    int n;
-
-    // source = s , sink = t
-    int s, t; 
-
-    // file name
-    string input_file_path;
-
-    // maximum flow value to compute
-    long max_flow=-1;
-
-    // graph (adjacency list)
-    vector<list<Edge *>> graph;
-
-    //
-    int visit_flag = 1;
-    vector<int> visited;
+    // a frame of the dfs stack: the node, the next edge to scan, the flow that reaches the node
+    // and the edge taken out of it
+    typedef struct {
+        int node;
+        list<Edge *>::iterator cursor;
+        long flow;
+        Edge *edge;
+    } frame_t;
+
+    // dfs stack, reserved for n frames by solve() so that it is never reallocated during a search
+    vector<frame_t> stack;
 
     /* Indicates whether the network flow algorithm has ran.
     We would not need to run the solver multiple times, because it always yields the same result. */
     bool solved;
 
-    // to avoid overflow
-    const long INF = __LONG_LONG_MAX__ / 2;
+    // hot-path counters (compiled in with -DMAXFLOW_COUNTERS)
+    ThreadMonitor monitor;
 
 public:
-    // constructor
-    MaxFlowSolver(string input_file_path)
+    /**
+     * constructor
+     * @param read_edges the edges of the input file if the caller read them already (e.g. for the
+     *        statistics of the graph or for the checker), nullptr to read the file
+     */
+    MaxFlowSolver(string input_file_path, const edge_list_t *read_edges = nullptr)
     {
-        this->input_file_path = input_file_path;
-        this->max_flow = 0;
         this->solved = false;
-        this->graph = readGraph();
-        this->visited = vector<int>(this->n);
-        
-        // in our implementation, we assume to have a source node and a sink node:
-        // the source node is assumed to have index 0
-        // the sink node is assumed to have index n-1 (with n = # nodes)
-        // this->s = 0; 
-        // this->t = this->n - 1; 
-        this->s = 0; 
-        this->t = this->n -1; 
-       // cout << "Source: " << this->s << ", Sink: " << this->t << endl;
+        loadGraph(input_file_path, read_edges);
     }
 
-    long getMaxFlow() {
-        return this->max_flow;
-    }
-
-    // read the graph and save it into an adjacency list
-    vector<list<Edge *>> readGraph(){
-    
-        ifstream file(this->input_file_path);
-
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << this->input_file_path << std::endl;
-            return graph; // Return an empty list
-        }
-
-        char *end;
-        string line;
-        getline(file, line);
-        this->n = strtol(line.c_str(), &end, 10);
-        cout << "Number of nodes: " << this->n << endl;
-
-        vector<list<Edge *>> graph(this->n);
-        int i = 0;
-        while (getline(file, line)) {
-            i++;
-            // assuming format "node1 node2 capacity"
-            int start_node = strtol(line.c_str(), &end, 10);
-            int end_node = strtol(end + 1, &end, 10);
-            long capacity = strtol(end + 1, &end, 10);
-
-            Edge *edge = new Edge(start_node, end_node, capacity);
-            Edge *edge_residual = new Edge(end_node, start_node, 0);
-            
-            edge->setResidual(edge_residual); // set the residual edge 
-            edge_residual->setResidual(edge); // set the foward edge as "residual" of the residual edge
-            
-/*             cout << "adding line " << i <<  ": " << line << endl;
-            cout << "adding to Graph " << start_node << endl;
-            cout << "adding to Graph " << end_node << endl; */
-            graph[start_node].push_back(edge);
-            graph[end_node].push_back(edge_residual);
-
-            
-        }
-        cout << "Graph read" << endl;
-        return graph;
+    // constructor for networks with many sources and sinks, joined by virtual terminals
+    MaxFlowSolver(string input_file_path, vector<int> sources, vector<int> sinks, const edge_list_t *read_edges = nullptr)
+        : MaxFlowSolver(input_file_path, read_edges)
+    {
+        this->valid = this->valid && attachTerminals(sources, sinks);
     }
 
+    // the solver owns its edges, it cannot be copied
+    MaxFlowSolver(const MaxFlowSolver &) = delete;
+    MaxFlowSolver &operator=(const MaxFlowSolver &) = delete;
 
-    // print the graph in format edge - edge, capacity
-    void printGraph() {
-        for (auto node : this->graph) {
-            for (auto edge : node) {
-                if (!edge->isResidual()) 
-                    cout << edge->toString() << endl;
-            }
-        }
+    string getName() {
+        return "sequential";
     }
 
-    // print resulting graph to file
-    void printGraphToFile(string fout) {
-        //string output = "result.txt";
-        ofstream outputFile(fout);
-        
-        if (!outputFile.is_open()) {
-            std::cerr << "Failed to open file: " << fout << std::endl;
+    void solve(){
+        // the input file was not loaded or the terminals are invalid: there is no network to solve
+        if (!this->valid) {
+            this->max_flow = -1;
             return;
         }
-   
-        for (auto node : this->graph) {
-            for (auto edge : node) {
-                if (!edge->isResidual()) 
-                    outputFile << edge->toStringFile() << endl;
-            }
-        }
-        
-        outputFile.close();
-    }
-
-
-    /// Prints the residual graph in format "edge - edge, residual_capacity"
-    void printGraphResidual() {
-        for (auto node : this->graph){
-            for (auto edge : node){
-                cout << edge->toString() << endl;
-            }
-        }
-    }
-
-    void setVisited(int i){
-        this->visited[i] = this->visit_flag;
-        return;
-    }
-
-    // Returns whether or not node 'i' has been visited.
-    bool isVisited(int i){
-        return this->visited[i] == this->visit_flag;
-    }
-
-    // to see if useful?
-    void markAllNodesAsUnvisited(){
-        visit_flag++;
-    }
-
-    void solve(){
+        PhaseTimer::Scope phase(this->timer, "solve");
+        this->stack.reserve(this->n);
         // compute max flow
-        for (long f = dfs(this->s, INF); f != 0; f = dfs(this->s, INF)){
+        while (true) {
+            long f;
+            {
+                TRACE_SCOPE("search");
+                PhaseTimer::Scope search_phase(this->timer, "search");
+                f = dfs(this->s, INF);
+            }
+            if (f == 0)
+                break;
             this->visit_flag++;
             this->max_flow += f;
+            MONITOR_ADD(this->monitor, AUGMENTATIONS, 1);
         }
+
+        // give the flow of the reduced edges back to the original ones
+        expandSimplifiedGraph();
+        this->monitor.dumpState(getName());
     }
 
+    /* Finds an augmenting path from node to the sink with an explicit stack, augments it and returns its
+    bottleneck (0 if there is none). Every frame keeps its position in the adjacency list of its node,
+    so the edges are scanned in the same order as a recursive search, without any call per hop. */
     long dfs(int node, long flow) {
-        if (node == this->t) {
-            return flow;
-        }
-
+        this->stack.clear();
+        this->stack.push_back({node, this->graph[node].begin(), flow, nullptr});
         this->visited[node] = visit_flag;
 
-        list<Edge *> node_edges = this->graph[node];
-        for (Edge *edge : node_edges) {
-            if (edge->getRemainingCapacity() > 0 && this->visited[edge->getEndNode()] != visit_flag) {
-                long bottleNeck = dfs(edge->getEndNode(), min(flow, edge->getRemainingCapacity()));
-                if (bottleNeck > 0) {
-                    edge->augment(bottleNeck); 
-                    return bottleNeck;
+        while (!this->stack.empty() && this->stack.back().node != this->t) {
+            frame_t &top = this->stack.back();
+            list<Edge *> &node_edges = this->graph[top.node];
+            bool pushed = false;
+            while (top.cursor != node_edges.end()) {
+                Edge *edge = *top.cursor++;
+                MONITOR_ADD(this->monitor, ARCS_SCANNED, 1);
+                int next_node = edge->getEndNode();
+                if (edge->getRemainingCapacity() > 0 && this->visited[next_node] != visit_flag) {
+                    this->visited[next_node] = visit_flag;
+                    top.edge = edge;
+                    this->stack.push_back({next_node, this->graph[next_node].begin(),
+                                           min(top.flow, edge->getRemainingCapacity()), nullptr});
+                    pushed = true;
+                    break;
                 }
             }
+            if (!pushed) {
+                this->stack.pop_back();
+            }
+        }
+        if (this->stack.empty()) {
+            return 0;
+        }
+
+        // the flow of the sink frame is the bottleneck of the path
+        long bottleNeck = this->stack.back().flow;
+        for (size_t i = 0; i + 1 < this->stack.size(); i++) {
+            this->stack[i].edge->augment(bottleNeck);
         }
-        return 0;
+        return bottleNeck;
     }
  
     long bfs(){return 0.00;}
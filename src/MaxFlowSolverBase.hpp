@@ -0,0 +1,405 @@
+// Header file that contains the interface and the network shared by the Maximum Flow solvers
+// Both solvers hold the same adjacency lists of Edge: reading, virtual terminals, pruning,
+// simplification, min cut and output are done here once, only solve() differs.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+
+#include "Edge.hpp"
+#include "PhaseTimer.hpp"
+#include "FlowWriter.hpp"
+#include "GraphPruning.hpp"
+#include "GraphSimplification.hpp"
+#include "GraphReader.hpp"
+
+using namespace std;
+
+class MaxFlowSolverBase
+{
+protected:
+    //  number of nodes
+    int n = 0;
+
+    // number of nodes of the input file (virtual terminals excluded)
+    int num_real_nodes = 0;
+
+    // source = s , sink = t
+    int s = 0, t = -1;
+
+    // file name
+    string input_file_path;
+
+    // maximum flow value to compute, -1 once solve() is called on an invalid network
+    long max_flow = 0;
+
+    // graph (adjacency list)
+    vector<list<Edge *>> graph;
+
+    //
+    int visit_flag = 1;
+    vector<int> visited;
+
+    // saturated edges going from the source side to the sink side of the min cut
+    vector<Edge *> min_cut;
+
+    // edges of the input file in output order, and input id of every node (they differ after pruneGraph)
+    vector<output_edge_t> output_edges;
+    vector<int> original_id;
+
+    // reductions applied by simplifyGraph(), undone at the end of solve()
+    GraphSimplifier simplifier;
+    bool simplified = false;
+
+    // to avoid overflow
+    const long INF = __LONG_LONG_MAX__ / 2;
+
+    // wall and CPU time of the phases run by the solver (parse, build, solve...)
+    PhaseTimer timer;
+
+    // false if the network cannot be solved as asked (input file not loaded, invalid terminals)
+    bool valid = true;
+
+    /**
+     * Reads the network of the input file, called by the constructors of the solvers.
+     * @param read_edges the edges of the input file if the caller read them already (e.g. for the
+     *        statistics of the graph or for the checker), nullptr to read the file
+     */
+    void loadGraph(string input_file_path, const edge_list_t *read_edges) {
+        this->input_file_path = input_file_path;
+        this->graph = readGraph(read_edges);
+        this->visited = vector<int>(this->n);
+
+        // the source node (s) and the sink node (t) are set by readGraph(): node 0 and node n-1,
+        // unless the input file gives them
+        this->num_real_nodes = this->n;
+        this->original_id = vector<int>(this->n);
+        for (int i = 0; i < this->n; i++)
+            this->original_id[i] = i;
+        onNodesChanged();
+    }
+
+    // called whenever the nodes are created or renumbered (load, virtual terminals, pruning), for
+    // the solvers that keep per-node state of their own
+    virtual void onNodesChanged() {}
+
+public:
+    virtual ~MaxFlowSolverBase()
+    {
+        // frees every edge (each one is in exactly one adjacency list)
+        if (this->simplified)
+            this->graph = this->simplifier.expand();
+        for (auto &node_edges : this->graph) {
+            for (Edge *edge : node_edges)
+                delete edge;
+        }
+    }
+
+    // name of the engine, used in logs and reports
+    virtual string getName() = 0;
+
+    virtual void solve() = 0;
+
+    long getMaxFlow() {
+        return this->max_flow;
+    }
+
+    bool isValid() {
+        return this->valid;
+    }
+
+    PhaseTimer &getPhaseTimer() {
+        return this->timer;
+    }
+
+    // read the graph and save it into an adjacency list
+    vector<list<Edge *>> readGraph(const edge_list_t *read_edges = nullptr){
+        // parse the whole file first (either format, see readEdgeList()), so that parsing and building are timed separately
+        edge_list_t parsed_edges;
+        if (read_edges == nullptr) {
+            PhaseTimer::Scope phase(this->timer, "parse");
+            parsed_edges = readEdgeList(this->input_file_path);
+        }
+        const edge_list_t &edges = read_edges ? *read_edges : parsed_edges;
+        if (!edges.loaded) {
+            this->n = 0;
+            this->s = 0;
+            this->t = -1;
+            this->valid = false;
+            return graph; // Return an empty list
+        }
+        this->n = edges.n;
+        cout << "Number of nodes: " << this->n << endl;
+
+        // node 0 and node n-1, unless the file gives the terminals (DIMACS)
+        this->s = edgeListSource(edges);
+        this->t = edgeListSink(edges);
+
+        PhaseTimer::Scope phase(this->timer, "build");
+        vector<list<Edge *>> graph(this->n);
+        for (size_t i = 0; i < edges.tails.size(); i++) {
+            int start_node = edges.tails[i];
+            int end_node = edges.heads[i];
+            long capacity = edges.capacities[i];
+
+            Edge *edge = new Edge(start_node, end_node, capacity);
+            Edge *edge_residual = new Edge(end_node, start_node, 0);
+
+            edge->setResidual(edge_residual); // set the residual edge
+            edge_residual->setResidual(edge); // set the foward edge as "residual" of the residual edge
+
+            graph[start_node].push_back(edge);
+            graph[end_node].push_back(edge_residual);
+        }
+        // remember the edges in output order, before any transformation of the graph
+        for (auto &node_edges : graph) {
+            for (Edge *edge : node_edges) {
+                if (!edge->isResidual())
+                    this->output_edges.push_back({edge->getStartNode(), edge->getEndNode(), edge});
+            }
+        }
+        cout << "Graph read" << endl;
+        return graph;
+    }
+
+
+    /* Attaches a virtual super-source connected to every node of 'sources' and a virtual super-sink
+    reached from every node of 'sinks', so that the solver runs unchanged from s to t. The virtual
+    nodes get ids n and n+1 and their edges have INF capacity, so they never appear in a min cut
+    and they are never written to the output.
+    Returns false, and leaves the network unchanged, if a terminal is not a node or is both a source and a sink. */
+    bool attachTerminals(vector<int> sources, vector<int> sinks) {
+        PhaseTimer::Scope phase(this->timer, "build");
+        // keep the default terminals for the side that is not given
+        if (sources.empty())
+            sources.push_back(0);
+        if (sinks.empty())
+            sinks.push_back(this->num_real_nodes - 1);
+
+        // a node listed twice gets one virtual edge
+        sort(sources.begin(), sources.end());
+        sources.erase(unique(sources.begin(), sources.end()), sources.end());
+        sort(sinks.begin(), sinks.end());
+        sinks.erase(unique(sinks.begin(), sinks.end()), sinks.end());
+
+        for (int source : sources) {
+            if (source < 0 || source >= this->num_real_nodes) {
+                std::cerr << "Invalid source node: " << source << std::endl;
+                return false;
+            }
+        }
+        for (int sink : sinks) {
+            if (sink < 0 || sink >= this->num_real_nodes) {
+                std::cerr << "Invalid sink node: " << sink << std::endl;
+                return false;
+            }
+            if (binary_search(sources.begin(), sources.end(), sink)) {
+                std::cerr << "Node " << sink << " cannot be both a source and a sink" << std::endl;
+                return false;
+            }
+        }
+
+        this->s = this->n;
+        this->t = this->n + 1;
+        this->n += 2;
+        this->graph.resize(this->n);
+        this->visited.resize(this->n);
+        this->original_id.push_back(this->num_real_nodes);
+        this->original_id.push_back(this->num_real_nodes + 1);
+
+        for (int source : sources)
+            addVirtualEdge(this->s, source);
+        for (int sink : sinks)
+            addVirtualEdge(sink, this->t);
+        onNodesChanged();
+        return true;
+    }
+
+    void addVirtualEdge(int start_node, int end_node) {
+        Edge *edge = new Edge(start_node, end_node, INF);
+        Edge *edge_residual = new Edge(end_node, start_node, 0);
+
+        edge->setResidual(edge_residual);
+        edge_residual->setResidual(edge);
+
+        this->graph[start_node].push_back(edge);
+        this->graph[end_node].push_back(edge_residual);
+    }
+
+    // check if an edge touches a virtual terminal
+    bool isVirtual(Edge *edge) {
+        return this->original_id[edge->getStartNode()] >= this->num_real_nodes ||
+               this->original_id[edge->getEndNode()] >= this->num_real_nodes;
+    }
+
+    /* Drops every node that is not reachable from s or cannot reach t, together with its edges,
+    and gives compact ids to the remaining nodes. Must be called before solve(). The mapping to the
+    input ids is kept in original_id, so the output files still report the edges of the input file. */
+    void pruneGraph() {
+        if (!this->valid)
+            return;
+        PhaseTimer::Scope phase(this->timer, "prune");
+        vector<int> compact_id = computeCompactIds(this->graph, this->s, this->t);
+        vector<int> kept_original_id;
+        for (int i = 0; i < this->n; i++) {
+            if (compact_id[i] != -1)
+                kept_original_id.push_back(this->original_id[i]);
+        }
+
+        for (output_edge_t &out : this->output_edges) {
+            if (out.edge && (compact_id[out.edge->getStartNode()] == -1 || compact_id[out.edge->getEndNode()] == -1))
+                out.edge = nullptr;
+        }
+        this->graph = compactGraph(this->graph, compact_id, kept_original_id.size());
+        cout << "Pruned graph: kept " << kept_original_id.size() << " of " << this->n << " nodes" << endl;
+
+        this->s = compact_id[this->s];
+        this->t = compact_id[this->t];
+        this->n = kept_original_id.size();
+        this->original_id = kept_original_id;
+        this->visited = vector<int>(this->n);
+        onNodesChanged();
+    }
+
+    /* Merges parallel edges and contracts chains of nodes with one incoming and one outgoing edge.
+    Must be called before solve(), which expands the flow back onto the original edges at the end. */
+    void simplifyGraph() {
+        if (!this->valid)
+            return;
+        PhaseTimer::Scope phase(this->timer, "simplify");
+        this->graph = this->simplifier.simplify(this->graph, this->s, this->t);
+        this->simplified = true;
+    }
+
+    // gives the flow of the reduced edges back to the original ones, at the end of solve()
+    void expandSimplifiedGraph() {
+        if (this->simplified) {
+            this->graph = this->simplifier.expand();
+            this->simplified = false;
+        }
+    }
+
+    // print the graph in format edge - edge, capacity
+    void printGraph() {
+        for (auto node : this->graph) {
+            for (auto edge : node) {
+                if (!edge->isResidual() && !isVirtual(edge))
+                    cout << edge->toString() << endl;
+            }
+        }
+    }
+
+    // print resulting graph to file
+    void printGraphToFile(string fout) {
+        writeFlowToFile(fout, {OUTPUT_ALL, false, 1});
+    }
+
+    // Prints the flow as a DIMACS solution: "s max_flow", then "f node1 node2 flow" in the order of printGraphToFile(), 1-based ids
+    void printDimacsFlowToFile(string fout) {
+        writeFlowToFile(fout, {OUTPUT_ALL, true, 1});
+    }
+
+    // Writes the flow of the edges in output order, with the mode and the threads of 'options' (see FlowWriter.hpp)
+    void writeFlowToFile(string fout, output_options_t options) {
+        if (options.mode == OUTPUT_CUT)
+            computeMinCut();
+
+        // pruned edges never carried flow
+        auto record = [this](size_t i) {
+            const output_edge_t &out = this->output_edges[i];
+            return flow_record_t{out.start_node, out.end_node, out.edge ? out.edge->getFlow() : 0};
+        };
+        auto crosses_cut = [this](size_t i) {
+            Edge *edge = this->output_edges[i].edge;
+            return edge && isOnSourceSide(edge->getStartNode()) && !isOnSourceSide(edge->getEndNode());
+        };
+        writeFlowFile(fout, this->output_edges.size(), record, crosses_cut, this->max_flow, options);
+    }
+
+
+    /// Prints the residual graph in format "edge - edge, residual_capacity"
+    void printGraphResidual() {
+        for (auto node : this->graph){
+            for (auto edge : node){
+                cout << edge->toString() << endl;
+            }
+        }
+    }
+
+    void setVisited(int i){
+        this->visited[i] = this->visit_flag;
+        return;
+    }
+
+    // Returns whether or not node 'i' has been visited.
+    bool isVisited(int i){
+        return this->visited[i] == this->visit_flag;
+    }
+
+    // to see if useful?
+    void markAllNodesAsUnvisited(){
+        visit_flag++;
+    }
+
+    /* Computes the min cut from the final residual graph: the source side is the set of nodes
+    still reachable from s through edges with remaining capacity, and the cut is made of the
+    (saturated) edges leaving it. Must be called after solve(). */
+    vector<Edge *> computeMinCut() {
+        this->min_cut.clear();
+        if (!this->valid)
+            return this->min_cut;
+        markAllNodesAsUnvisited();
+
+        vector<int> stack;
+        stack.push_back(this->s);
+        setVisited(this->s);
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            for (Edge *edge : this->graph[node]) {
+                int next_node = edge->getEndNode();
+                if (edge->getRemainingCapacity() > 0 && !isVisited(next_node)) {
+                    setVisited(next_node);
+                    stack.push_back(next_node);
+                }
+            }
+        }
+
+        for (int i = 0; i < this->n; i++) {
+            if (!isVisited(i))
+                continue;
+            for (Edge *edge : this->graph[i]) {
+                if (!edge->isResidual() && !isVisited(edge->getEndNode()))
+                    this->min_cut.push_back(edge);
+            }
+        }
+        return this->min_cut;
+    }
+
+    // Returns whether node 'i' is on the source side of the last computed min cut
+    bool isOnSourceSide(int i) {
+        return isVisited(i);
+    }
+
+    // print the edges of the min cut to file, in format "node1 node2 capacity"
+    void printMinCutToFile(string fout) {
+        ofstream outputFile(fout);
+
+        if (!outputFile.is_open()) {
+            std::cerr << "Failed to open file: " << fout << std::endl;
+            return;
+        }
+
+        for (Edge *edge : this->min_cut) {
+            outputFile << this->original_id[edge->getStartNode()] << " " << this->original_id[edge->getEndNode()]
+                       << " " << edge->getCapacity() << "\n";
+        }
+
+        outputFile.close();
+    }
+};
@@ -18,7 +18,7 @@
 #include "Edge.hpp"
 #include "NodeFirst.hpp"
 #include "ThreadLogger.hpp"
-std::mutex Logger::cout_mutex;
+#include "FlowWriter.hpp"
 
 using namespace std;
 /*   
@@ -57,7 +57,6 @@ using namespace std;
 Happy New Year 2025!
 da MGM
  */
-ofstream tmpfout;
 void reorderFile(const std::string &inputFile, const std::string &outputFile);
 
 class MaxFlowSolverParallel
@@ -229,22 +228,22 @@ public:
 
     // print resulting graph to file
     void printGraphToFile(string fout) {
-        //string output = "result.txt";
-        ofstream outputFile(fout);
-        
-        if (!outputFile.is_open()) {
+        int fd = open(fout.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
             std::cerr << "Failed to open file: " << fout << std::endl;
             return;
         }
-   
-        for (auto node : this->graph) {
-            for (auto edge : node) {
-                if (!edge->isResidual()) 
-                    outputFile << edge->toStringFile() << endl;
+
+        {
+            BufferedWriter writer(fd);
+            for (const auto &node : this->graph) {
+                for (Edge *edge : node) {
+                    if (!edge->isResidual())
+                        writer.writeLine({edge->getStartNode(), edge->getEndNode(), edge->getFlow()}, false);
+                }
             }
         }
-        
-        outputFile.close();
+        close(fd);
     }
 
 
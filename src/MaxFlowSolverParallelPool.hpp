@@ -1,5 +1,6 @@
 // Header file that contains the Maximum Flow Graph algorithm
 // Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
 
 #include <iostream>
 #include <list>
@@ -16,50 +17,46 @@
 #include <sstream>
 
 #include "Edge.hpp"
+#include "MaxFlowSolverBase.hpp"
 #include "Node.hpp"
+#include "AtomicBitset.hpp"
 #include "ThreadPool.hpp"
+#include "CacheLine.hpp"
 
 using namespace std; 
-ofstream tmpfout;
 //void reorderFile(const std::string &inputFile, const std::string &outputFile);
 
-class MaxFlowSolverParallelPool
+class MaxFlowSolverParallelPool : public MaxFlowSolverBase
 {
 private:
-    // INPUTS
-    
-    int n;      //  number of nodes
-    int s, t;   // source = s , sink = t
-
-    string input_file_path;     // file name
-
-    // maximum flow value to compute
-    long max_flow=0;
-
-    // graph (adjacency list)
-    vector<list<Edge *>> graph;
-
-    //
-    int visit_flag = 1;
-    vector<int> visited;
     // vector<Node> nodes;
     vector<Node *> nodes;
 
+    // one bit per node, set once its label is written: the neighbour scans only read this bitset
+    AtomicBitset labeled;
+    // labels of the nodes (cold data), read only after the bit of the node is seen set
+    vector<label_t> labels;
+
     /* Indicates whether the network flow algorithm has ran.
     We would not need to run the solver multiple times, because it always yields the same result. */
     bool solved;
 
-    // to avoid overflow
-    const long INF = __LONG_LONG_MAX__ / 2;
     std::mutex graph_lock;
 
-    atomic<bool> done;  // flag to indicate if there is no more augmenting flow left
+    // Shared state of the labeling jobs, in control blocks that each start on their own cache line:
+    // sink_reached is read by every job on every neighbour, so no counter written by the threads
+    // may share its line.
+    CACHE_ALIGNED atomic<bool> done;  // flag to indicate if there is no more augmenting flow left
     atomic<bool> sink_reached;  // flag to indicate if the sink node is labelled
-    atomic<int> num_generated;  // # of generated threads
+
+    CACHE_ALIGNED atomic<int> num_generated;  // # of generated threads
     atomic<int> num_blocked;    // # of threads blocked on cv next_iteration
     atomic<int> num_waiting_label;
     atomic<int> num_running;
-    condition_variable cv, cv_augment;
+
+    CACHE_ALIGNED atomic<int> pending_jobs{0}; // Track total active jobs
+
+    CACHE_ALIGNED condition_variable cv, cv_augment;
     mutex mx_cv, mx_cv_augment;
 
     // create a vector of threads
@@ -75,25 +72,19 @@ private:
 
     std::chrono::time_point<std::chrono::high_resolution_clock> start;  // reference time instant
 
-    atomic<int> pending_jobs{0}; // Track total active jobs
+    int num_threads = 0;    // threads of the pool, 0 means hardware concurrency
 public:
-    // constructor
-    MaxFlowSolverParallelPool(string input_file_path)
+    /**
+     * constructor
+     * @param read_edges the edges of the input file if the caller read them already (e.g. for the
+     *        statistics of the graph or for the checker), nullptr to read the file
+     */
+    MaxFlowSolverParallelPool(string input_file_path, const edge_list_t *read_edges = nullptr)
     {
-        this->input_file_path = input_file_path;
-        this->max_flow = 0;
         this->solved = false;
-        this->graph = readGraph();
-        this->visited = vector<int> (this->n);
         this->augmenter_thread_exists.store(false);
         // this->toContinue.store(false);
-        
-        // in our implementation, we assume to have a source node and a sink node:
-        // the source node is assumed to have index 0
-        // the sink node is assumed to have index n-1 (with n = # nodes)
-        this->s = 0; 
-        this->t = this->n -1; 
-       // cout << "Source: " << this->s << ", Sink: " << this->t << endl;
+        loadGraph(input_file_path, read_edges);
         this->done.store(false);
         this->sink_reached.store(false);
         this->num_generated.store(0);
@@ -102,131 +93,46 @@ public:
         this->num_running.store(0);
     }
 
-    long getMaxFlow() {
-        return this->max_flow;
+    // constructor for networks with many sources and sinks, joined by virtual terminals
+    MaxFlowSolverParallelPool(string input_file_path, vector<int> sources, vector<int> sinks, const edge_list_t *read_edges = nullptr)
+        : MaxFlowSolverParallelPool(input_file_path, read_edges)
+    {
+        this->valid = this->valid && attachTerminals(sources, sinks);
     }
 
-    // read the graph and save it into an adjacency list
-    vector<list<Edge *>> readGraph(){
-    
-        ifstream file(this->input_file_path);
-
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file: " << this->input_file_path << std::endl;
-            return graph; // Return an empty list
-        }
-
-        char *end;
-        string line;
-        getline(file, line);
-        this->n = strtol(line.c_str(), &end, 10);
-        cout << "Number of nodes: " << this->n << endl;
+    // the solver owns its edges, it cannot be copied
+    MaxFlowSolverParallelPool(const MaxFlowSolverParallelPool &) = delete;
+    MaxFlowSolverParallelPool &operator=(const MaxFlowSolverParallelPool &) = delete;
 
-        vector<list<Edge *>> graph(this->n);
-
-        this->nodes = vector<Node *>(this->n);
-        // cout << "initialized nodes vector with size: " << nodes.size() << endl;
-
-        int i = 0;
-        while (getline(file, line)) {
-            i++;
-            // assuming format "node1 node2 capacity"
-            int start_node = strtol(line.c_str(), &end, 10);
-            int end_node = strtol(end + 1, &end, 10);
-            long capacity = strtol(end + 1, &end, 10);
-
-            Edge *edge = new Edge(start_node, end_node, capacity);
-            Edge *edge_residual = new Edge(end_node, start_node, 0);
-            
-            edge->setResidual(edge_residual); // set the residual edge 
-            edge_residual->setResidual(edge); // set the foward edge as "residual" of the residual edge
-            
-            // cout << "adding line " << i <<  ": " << line << endl;
-            // cout << "adding to Node " << start_node << endl;
-            graph[start_node].push_back(edge);
-            graph[end_node].push_back(edge_residual);
-            
-            // cout << "before start node" << endl;
-            // cout << "this->nodes[start_node]: " << this->nodes[start_node] << endl;
-            if (this->nodes[start_node] == nullptr) {
-                Node *node1 = new Node(start_node);
-                this->nodes[start_node] = node1;
-            }
-            // cout << "after start node" << endl;
-            // cout << "before end node" << endl;
-
-            if (this->nodes[end_node] == nullptr) {
-                Node *node2 = new Node(end_node);
-                this->nodes[end_node] = node2;
-            }            
-            // cout << "after end node" << endl;
-        }
-        // cout << "hey" << endl;
-        cout << "Graph read  " << endl;
-        for (Node* nd : this->nodes) {
-          //   cout << nd->getId() << " ";
+    // destructor: frees the nodes, the edges are freed by MaxFlowSolverBase
+    ~MaxFlowSolverParallelPool()
+    {
+        for (Node *node : this->nodes) {
+            if (node)
+                delete node;
         }
-       //  cout << endl;
-        return graph;
     }
 
-
-    // print the graph in format edge - edge, capacity
-    void printGraph() {
-        for (auto node : this->graph) {
-            for (auto edge : node) {
-                if (!edge->isResidual()) 
-                    cout << edge->toString() << endl;
-            }
-        }
+    string getName() {
+        return "parallel";
     }
 
-    // print resulting graph to file
-    void printGraphToFile(string fout) {
-        //string output = "result.txt";
-        ofstream outputFile(fout);
-        
-        if (!outputFile.is_open()) {
-            std::cerr << "Failed to open file: " << fout << std::endl;
-            return;
-        }
-   
-        for (auto node : this->graph) {
-            for (auto edge : node) {
-                if (!edge->isResidual()) 
-                    outputFile << edge->toStringFile() << endl;
-            }
-        }
-        
-        outputFile.close();
+    // set the number of threads of the pool used by solve()
+    void setNumThreads(int num_threads) {
+        this->num_threads = num_threads;
     }
 
-
-    /// Prints the residual graph in format "edge - edge, residual_capacity"
-    void printGraphResidual() {
-        for (auto node : this->graph){
-            for (auto edge : node){
-                cout << edge->toString() << endl;
-            }
+    // the nodes are (re)created with the ids of the network: on load, with the virtual terminals, after pruning
+    void onNodesChanged() {
+        for (Node *node : this->nodes) {
+            if (node)
+                delete node;
         }
+        this->nodes = vector<Node *>(this->n);
+        for (int i = 0; i < this->n; i++)
+            this->nodes[i] = new Node(i);
     }
 
-    void setVisited(int i){
-        this->visited[i] = this->visit_flag;
-        return;
-    }
-
-    // Returns whether or not node 'i' has been visited.
-    bool isVisited(int i){
-        return this->visited[i] == this->visit_flag;
-    }
-
-    // to see if useful?
-    void markAllNodesAsUnvisited(){
-        visit_flag++;
-    }
-
-
     auto computeTime() {
         auto now = std::chrono::high_resolution_clock::now();    // time instant now
         auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->start);    // duration from start instant till current point in time
@@ -304,8 +210,8 @@ public:
    }
    */
     void thread_function(ThreadPool &thread_pool, int u, int v, Edge *edge) {
+        TRACE_SCOPE("label");
         // thread_pool.getMonitor().updateState("Starting task for nodes " + std::to_string(u) + "," + std::to_string(v));
-        bool enqueued_any = false;
        // Logger() << "thread " << u << " " << v;
         Node* node_u = this->nodes[u];
         Node* node_v = this->nodes[v];
@@ -317,19 +223,21 @@ public:
        //  Logger() << "locking " << u << " " << v;
         if (u < v)
         {
-            node_u->lockSharedMutex();
-            node_v->lockSharedMutex();
+            lockNode(thread_pool, node_u);
+            lockNode(thread_pool, node_v);
         }
         else
         {
-            node_v->lockSharedMutex();
-            node_u->lockSharedMutex();
+            lockNode(thread_pool, node_v);
+            lockNode(thread_pool, node_u);
         }
         // thread_pool.getMonitor().updateState("Got locks for nodes " + std::to_string(u) + "," + std::to_string(v));
        //  Logger() << "locked " << u << " " << v;
         
         // treat labelling
-        if (!this->assign_label(node_u, node_v, edge)){
+        MONITOR_ADD(thread_pool.getMonitor(), LABEL_ATTEMPTS, 1);
+        if (!this->assign_label(u, v, edge)){
+            MONITOR_ADD(thread_pool.getMonitor(), LABEL_FAILURES, 1);
            //  Logger() << "thread " << u << " " << v << " label not assigned";
             // thread_pool.getMonitor().updateState("Releasing locks for nodes " + std::to_string(u) + "," + std::to_string(v));
             node_u->unlockSharedMutex();
@@ -350,8 +258,10 @@ public:
 
         list<Edge *> neighbour_edges = this->graph[v];
      //    Logger() << "thread " << u << " " << v << " neighbours "<< neighbour_edges.size();
+        long arcs_scanned = 0;
         for (auto next_edge : neighbour_edges)
         {
+            arcs_scanned++;
             // Skip if sink is already reached
             if (this->sink_reached.load())
             {
@@ -368,7 +278,7 @@ public:
            //  Logger() << "thread " << u << " " << v << " has neighbohour id " << next_node;
            //  Logger() << "thread " << u << " " << v << " has neighbohour edge " << next_edge->getStartNode() << " " << next_edge->getEndNode() << " with capacity " << next_edge->getRemainingCapacity();
            //  Logger() << "thread " << u << " " << v << " has neighbohour labeled " << nodes[next_node]->isLabeled();
-            if (!this->nodes[next_node]->isLabeled() &&
+            if (!this->labeled.test(next_node) &&
                 next_edge->getRemainingCapacity() > 0 &&
                 next_node != this->s && next_node != u )
             {
@@ -391,6 +301,8 @@ public:
             }
         }
 
+        MONITOR_ADD(thread_pool.getMonitor(), ARCS_SCANNED, arcs_scanned);
+
         // Logger() << "unlocking " << u << " " << v;
         // thread_pool->getMonitor().updateState("Unlocking nodes " + std::to_string(u) + "," + std::to_string(v));
         node_v->unlockSharedMutex();
@@ -401,20 +313,30 @@ public:
         // thread_pool.getMonitor().updateState("Thread " + std::to_string(u) + "," + std::to_string(v) + " done");
         return;
     }
+    // lock a node, counting the times another thread was already holding it
+    void lockNode([[maybe_unused]] ThreadPool &thread_pool, Node *node) {
+#ifdef MAXFLOW_COUNTERS
+        MONITOR_ADD(thread_pool.getMonitor(), LOCK_ACQUISITIONS, 1);
+        if (node->tryLockSharedMutex())
+            return;
+        MONITOR_ADD(thread_pool.getMonitor(), LOCK_CONTENDED, 1);
+#endif
+        node->lockSharedMutex();
+    }
+
     // if queue not empty, but sink reached -> isprocessing remains true, main doesn't wake up
-    bool assign_label(Node *n_u, Node *n_v, Edge *edge) {
+    bool assign_label(int u, int v, Edge *edge) {
         // check if we are handling residual edges
         if (edge->isResidual()){
-            Node* temp = n_u;
-            n_u = n_v;
-            n_v = temp;
+            int temp = u;
+            u = v;
+            v = temp;
         }
         
-        bool u_is_labeled = n_u->isLabeled();
-        bool v_is_labeled = n_v->isLabeled();
-        long pred_flow_u = n_u->getLabel()->flow;
-        long pred_flow_v = n_v->getLabel()->flow;
-        // Logger() << "assigning label"  << n_u->getId() << " " << n_v->getId();
+        bool u_is_labeled = this->labeled.test(u);
+        bool v_is_labeled = this->labeled.test(v);
+        long pred_flow_u = this->labels[u].flow;
+        long pred_flow_v = this->labels[v].flow;
         // Logger() << "u is labeled " << u_is_labeled << " v is labeled " << v_is_labeled;
         // Logger() << "pred flow u " << pred_flow_u << " pred flow v " << pred_flow_v;
 
@@ -427,8 +349,7 @@ public:
                 // assign the label (u, +, l(v)) to node v, Where l(v) = min(l(u), c(u, v) − f(u, v)).
                 long label_flow = min(pred_flow_u, remaining_capacity);
 
-                n_v->setLabel(n_u->getId(), '+', label_flow);
-            //    Logger() << "assigned label on" << n_v->getId();
+                setLabel(v, u, '+', label_flow, edge);
                 return true;
             }
         }
@@ -443,13 +364,10 @@ public:
                 // assign the label (v, −, l(u)) to node u, where l(u) = min(l(v), f(u, v))
                 // Logger() << "min: between " << pred_flow_v << " and " << edge_flow;
                 long label_flow = std::min(pred_flow_v, -edge_flow);
-               //  Logger() << "assigning label on" << n_u->getId();
                //  Logger() << "label flow " << label_flow;
 
-                n_u->setLabel(n_v->getId(), '-', label_flow);
+                setLabel(u, v, '-', label_flow, edge);
                
-                // Logger() << "assigned label on" << n_u->getId();
-                // Logger() << "label: " << n_u->getLabel()->pred_id << " " << n_u->getLabel()->sign << " " << n_u->getLabel()->flow;
                 return true;   
             }
 
@@ -460,10 +378,24 @@ public:
         return false;
     }
 
+    // writes the label of a node, then publishes it by setting its bit (the label is visible to whoever sees the bit)
+    void setLabel(int node, int pred_id, char sign, long flow, Edge *edge) {
+        this->labels[node] = {pred_id, sign, flow, edge};
+        this->labeled.set(node);
+    }
+
     void solve(){
+        // the input file was not loaded or the terminals are invalid: there is no network to solve
+        if (!this->valid) {
+            this->max_flow = -1;
+            return;
+        }
+        PhaseTimer::Scope phase(this->timer, "solve");
+        this->labeled.resize(this->n);
+        this->labels = vector<label_t>(this->n);
         // create thread pool
 
-        this->nodes[this->s]->setSourceLabel();     // set label of source node
+        setLabel(this->s, -1, '\0', INF, nullptr);     // set label of source node
 
 
         ThreadPool thread_pool;
@@ -473,35 +405,38 @@ public:
 
         // save edges of source node
         list<Edge *> source_edges = this->graph[this->s];
-        int num_source_edges = source_edges.size();
         //bool start = true;
      
-        thread_pool.Start();
+        thread_pool.Start(this->num_threads);
         while (true) {
-            for (auto edge : source_edges) {
-                if (edge->getRemainingCapacity() > 0) {
-                    int u = edge->getStartNode();
-                    int v = edge->getEndNode();
-                    //Logger() << "edge u " << u << " v " << v << " with edge remaining capacity " << edge->getRemainingCapacity();
-                    {
-                    // unique_lock<mutex> lock(mx);
-                    pending_jobs.fetch_add(1, std::memory_order_relaxed); 
-                    thread_pool.QueueJob([&thread_pool, this, u, v, edge] {
-                        thread_function(thread_pool, u, v, edge); });
+            // labeling: from the jobs of the source edges until every thread is idle
+            {
+                PhaseTimer::Scope search_phase(this->timer, "search");
+                for (auto edge : source_edges) {
+                    if (edge->getRemainingCapacity() > 0) {
+                        int u = edge->getStartNode();
+                        int v = edge->getEndNode();
+                        //Logger() << "edge u " << u << " v " << v << " with edge remaining capacity " << edge->getRemainingCapacity();
+                        {
+                        // unique_lock<mutex> lock(mx);
+                        pending_jobs.fetch_add(1, std::memory_order_relaxed); 
+                        thread_pool.QueueJob([&thread_pool, this, u, v, edge] {
+                            thread_function(thread_pool, u, v, edge); });
+                        }
+                        pending_jobs.fetch_sub(1, std::memory_order_relaxed); 
+                    } else {
+                        //Logger() << "edge u " << edge->getStartNode() << " v " << edge->getEndNode() << " with NEGATIVE or 0 edge remaining capacity: " << edge->getRemainingCapacity();
                     }
-                    pending_jobs.fetch_sub(1, std::memory_order_relaxed); 
-                } else {
-                    //Logger() << "edge u " << edge->getStartNode() << " v " << edge->getEndNode() << " with NEGATIVE or 0 edge remaining capacity: " << edge->getRemainingCapacity();
                 }
-            }
 
-            // cout << "wait for sink" << endl;
-            // Wait until job found sink  and Wait until all threads completed running tasks
-                 
+                // cout << "wait for sink" << endl;
+                // Wait until job found sink  and Wait until all threads completed running tasks
+                     
 
-            
-            // thread_pool.getMonitor().dumpState();
-            thread_pool.waitForCompletion();
+                
+                // thread_pool.getMonitor().dumpState();
+                thread_pool.waitForCompletion();
+            }
 
             // Logger() << "mina woke up" ;
             if (!this->sink_reached.load())
@@ -510,7 +445,7 @@ public:
                 break;
             }
             
-            float augment_flow = augment();
+            long augment_flow = augment();
             // if no augmentation was done, the algorithm is finished
             if (augment_flow <= 0){
                //  Logger() << "MAIN: augment flow <= 0";
@@ -519,6 +454,7 @@ public:
             }
            //  Logger() << "MAIN: augment flow: " << augment_flow;
             this->max_flow+= augment_flow;
+            MONITOR_ADD(thread_pool.getMonitor(), AUGMENTATIONS, 1);
            //  Logger() << "MAIN: max flow: " << this->max_flow;
            //  Logger() << "MAIN: resetting sink reached";
             // destroy queue
@@ -527,6 +463,7 @@ public:
 
             // reset labels
             resetLabels();
+            MONITOR_ADD(thread_pool.getMonitor(), RESET_PASSES, 1);
 
             // Logger() << "MAIN: recreating labels";
             // for (int i = 0; i < this->n; i++){
@@ -548,6 +485,10 @@ public:
         // stop thread pool
         // Logger() << "stopping thread pool";
         thread_pool.Stop();
+        thread_pool.getMonitor().dumpState(getName());
+
+        // give the flow of the reduced edges back to the original ones
+        expandSimplifiedGraph();
 
 
 
@@ -555,7 +496,6 @@ public:
         // free resources 
         for (int i = 0; i < this->n; i++){
             if (this->nodes[i]){
-                this->nodes[i]->freeLabel();
                 delete this->nodes[i];
                 this->nodes[i] = nullptr;
             }
@@ -564,27 +504,21 @@ public:
     }
 
     long augment() {  
+        TRACE_SCOPE("augment");
+        PhaseTimer::Scope phase(this->timer, "augment");
         
         // Step 3. let x = t, then do the following work until x = s.
         // • If the label of x is (y, +, l(x)), then let f(y, x) = f(y, x) + l(t)
         // • If the label of x is (y, −, l(x)), then let f(x, y) = f(x, y) − l(t)
         // • Let x = y
         int x = this->t;
-        int y = this->nodes[x]->getLabel()->pred_id;
-        Edge *e;
-        long sink_flow = this->nodes[x]->getLabel()->flow;
+        long sink_flow = this->labels[x].flow;
 
         while (x != s){
-            for (Edge *edge : this->graph[y]){
-                if (edge->getEndNode() == x) {
-                    e = edge;
-                    break;
-                }
-            }
-            // doesn't matter the sign in the label, if the label has - the residual edge is taken
-            e->augment(sink_flow);        
-            x = y;
-            y = this->nodes[x]->getLabel()->pred_id;
+            // the label keeps the edge y -> x that gave it (the residual edge if the label has -), which
+            // is not always the first edge y -> x of the list when there are parallel edges
+            this->labels[x].edge->augment(sink_flow);
+            x = this->labels[x].pred_id;
         }
 
         return sink_flow;
@@ -620,11 +554,11 @@ public:
 
 
     void resetLabels() {
-        // reset all the nodes' labels apart from source
-         for (int i = 0; i < this->n; i++){
-            if ( i != this->s && this->nodes[i] && this->nodes[i]->isLabeled())
-                this->nodes[i]->resetLabel();
-        }
+        TRACE_SCOPE("reset");
+        PhaseTimer::Scope phase(this->timer, "reset");
+        // reset all the nodes' labels apart from source, one word of the bitset at a time
+        this->labeled.clearAll();
+        this->labeled.set(this->s);
         this->sink_reached.store(false);        
     }
     
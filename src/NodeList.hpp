@@ -0,0 +1,37 @@
+// Header file that contains the parser of the node lists given on the command line (--sources, --sinks)
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
+using namespace std;
+
+/**
+ * Parses a comma separated list of node ids, e.g. "1,4,7".
+ * @param ids set to the ids of the list
+ * @return false if an entry is not an integer, 'bad_id' is then set to that entry
+ */
+inline bool parseNodeList(string list, vector<int> &ids, string &bad_id)
+{
+    ids.clear();
+    stringstream ss(list);
+    string id;
+    while (getline(ss, id, ',')) {
+        if (id.empty())
+            continue;
+        char *end;
+        errno = 0;
+        long value = strtol(id.c_str(), &end, 10);
+        if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX) {
+            bad_id = id;
+            return false;
+        }
+        ids.push_back((int)value);
+    }
+    return true;
+}
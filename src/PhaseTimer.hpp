@@ -0,0 +1,111 @@
+// Header file that contains class PhaseTimer
+// Wall time and CPU time of the phases of a run, plus the peak resident memory of the process.
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+using namespace std;
+
+// time spent in a phase, summed over all the times it ran
+typedef struct {
+    string name;
+    double wall_us;
+    double cpu_us;      // CPU time of the whole process (all threads) during the phase
+} phase_time_t;
+
+class PhaseTimer {
+    private:
+        // phases in the order they first ran
+        vector<phase_time_t> phases;
+
+        phase_time_t &find(const string &name) {
+            for (phase_time_t &phase : this->phases) {
+                if (phase.name == name)
+                    return phase;
+            }
+            this->phases.push_back({name, 0, 0});
+            return this->phases.back();
+        }
+
+    public:
+        // process CPU time in microseconds
+        static double cpuMicros() {
+            timespec ts;
+            clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+            return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+        }
+
+        static double wallMicros() {
+            auto now = chrono::steady_clock::now().time_since_epoch();
+            return chrono::duration_cast<chrono::nanoseconds>(now).count() / 1e3;
+        }
+
+        // peak resident set size of the process, in KB
+        static long peakRSSKB() {
+            struct rusage usage;
+            getrusage(RUSAGE_SELF, &usage);
+            return usage.ru_maxrss;
+        }
+
+        void add(const string &name, double wall_us, double cpu_us) {
+            phase_time_t &phase = find(name);
+            phase.wall_us += wall_us;
+            phase.cpu_us += cpu_us;
+        }
+
+        // adds the phases of another timer, e.g. of the parse made before the solver was created
+        void merge(const PhaseTimer &other) {
+            for (const phase_time_t &phase : other.phases)
+                add(phase.name, phase.wall_us, phase.cpu_us);
+        }
+
+        const vector<phase_time_t> &getPhases() const {
+            return this->phases;
+        }
+
+        // the phases as a JSON object: {"parse": {"wall_us": ..., "cpu_us": ...}, ...}
+        string toJSON() const {
+            stringstream json;
+            json << "{";
+            for (size_t i = 0; i < this->phases.size(); i++) {
+                json << (i ? ", " : "") << "\"" << this->phases[i].name << "\": {\"wall_us\": "
+                     << (long)this->phases[i].wall_us << ", \"cpu_us\": " << (long)this->phases[i].cpu_us << "}";
+            }
+            json << "}";
+            return json.str();
+        }
+
+        // adds the time spent in the enclosing scope to a phase
+        class Scope {
+            private:
+                PhaseTimer &timer;
+                string name;
+                double wall_start, cpu_start;
+
+            public:
+                Scope(PhaseTimer &timer, const string &name) : timer(timer), name(name) {
+                    this->wall_start = wallMicros();
+                    this->cpu_start = cpuMicros();
+                }
+
+                ~Scope() {
+                    this->timer.add(this->name, wallMicros() - this->wall_start, cpuMicros() - this->cpu_start);
+                }
+        };
+};
+
+/**
+ * One machine-readable record of a run, as a single JSON line:
+ * {"engine": ..., "input": ..., "max_flow": ..., "phases": {...}, "peak_rss_kb": ...}
+ */
+inline string runRecord(const string &engine, const string &input, long max_flow, const PhaseTimer &timer) {
+    stringstream json;
+    json << "{\"engine\": \"" << engine << "\", \"input\": \"" << input << "\", \"max_flow\": " << max_flow
+         << ", \"phases\": " << timer.toJSON() << ", \"peak_rss_kb\": " << PhaseTimer::peakRSSKB() << "}";
+    return json.str();
+}
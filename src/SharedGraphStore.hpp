@@ -0,0 +1,255 @@
+// Header file that contains the shared memory store of the networks
+// The arrays of a FlowNetworkT are copied once into a named POSIX shared memory segment, which every
+// process then maps read-only: the processes solving queries on the same graph share one copy of the
+// topology and of the capacities, and only allocate their own flows. A segment records the input file
+// it was built from, and a process only maps a segment built from its own input file.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+
+#include "FlowNetwork.hpp"
+
+using namespace std;
+
+const char SHARED_GRAPH_MAGIC[8] = {'M', 'F', 'S', 'H', 'M', '0', '0', '2'};
+
+// every array starts on its own cache line
+const size_t SHARED_ARRAY_ALIGNMENT = 64;
+
+// how long a process waits for the creator of a segment to fill it
+const int SHARED_GRAPH_WAIT_MS = 60000;
+
+// how long an unfinished segment stays unlocked before it is taken for the leftover of a creator that died
+const int SHARED_GRAPH_STALE_MS = 1000;
+
+// the input file of a segment: a segment built from another file, or from this file before it changed,
+// is never mapped
+typedef struct {
+    char path[PATH_MAX];        // canonical path
+    uint64_t size;
+    int64_t mtime_ns;
+} shared_graph_source_t;
+
+// start of a segment, followed by the arrays at the given offsets
+typedef struct {
+    char magic[8];
+    uint32_t ready;             // set by the creator once the arrays are written
+    shared_graph_source_t input;    // the input file the network was built from
+    uint32_t index_bytes;       // sizeof(index_t)
+    uint32_t capacity_bytes;    // sizeof(capacity_t)
+    uint64_t n, m, source, sink;
+    uint64_t first_arc, arc_tail, arc_head, arc_capacity, arc_reverse, edge_arc;   // offsets of the arrays
+    uint64_t total_bytes;
+} shared_graph_header_t;
+
+// POSIX names start with a single slash
+inline string sharedGraphName(string name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+/**
+ * The identity of an input file, to be recorded in its segment.
+ * @return false if it is not a regular file: a pipe has no identity to check
+ */
+inline bool sharedGraphSource(string input_file_path, shared_graph_source_t &source) {
+    char resolved[PATH_MAX];
+    struct stat info;
+    if (realpath(input_file_path.c_str(), resolved) == nullptr || stat(resolved, &info) != 0 || !S_ISREG(info.st_mode))
+        return false;
+    memset(&source, 0, sizeof(source));
+    snprintf(source.path, sizeof(source.path), "%s", resolved);
+    source.size = info.st_size;
+    source.mtime_ns = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+    return true;
+}
+
+inline bool sameSharedGraphSource(const shared_graph_source_t &a, const shared_graph_source_t &b) {
+    return strncmp(a.path, b.path, sizeof(a.path)) == 0 && a.size == b.size && a.mtime_ns == b.mtime_ns;
+}
+
+// offsets of the arrays of a network with n nodes and m edges, returns the size of the segment
+template <typename index_t, typename capacity_t>
+uint64_t layoutSharedGraph(shared_graph_header_t &header, uint64_t n, uint64_t m) {
+    uint64_t offset = sizeof(shared_graph_header_t);
+    auto place = [&offset](uint64_t bytes) {
+        offset = (offset + SHARED_ARRAY_ALIGNMENT - 1) / SHARED_ARRAY_ALIGNMENT * SHARED_ARRAY_ALIGNMENT;
+        uint64_t start = offset;
+        offset += bytes;
+        return start;
+    };
+    header.first_arc = place((n + 1) * sizeof(index_t));
+    header.arc_tail = place(2 * m * sizeof(index_t));
+    header.arc_head = place(2 * m * sizeof(index_t));
+    header.arc_capacity = place(2 * m * sizeof(capacity_t));
+    header.arc_reverse = place(2 * m * sizeof(index_t));
+    header.edge_arc = place(m * sizeof(index_t));
+    return offset;
+}
+
+/**
+ * Creates the segment 'name' with a copy of the arrays of the network, built from the input file 'source'.
+ * The creator holds a lock on the segment until it is ready, so that the others can tell a segment being
+ * filled from the leftover of a creator that died.
+ * @return false if the segment exists already (created by another process) or cannot be created
+ */
+template <typename index_t, typename capacity_t>
+bool createSharedNetwork(string name, const FlowNetworkT<index_t, capacity_t> &network,
+                         const shared_graph_source_t &source) {
+    name = sharedGraphName(name);
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        if (errno != EEXIST)
+            std::cerr << "Failed to create shared memory " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // released when the descriptor is closed, or when the process dies
+    flock(fd, LOCK_EX);
+
+    shared_graph_header_t header = {};
+    memcpy(header.magic, SHARED_GRAPH_MAGIC, sizeof(header.magic));
+    header.input = source;
+    header.index_bytes = sizeof(index_t);
+    header.capacity_bytes = sizeof(capacity_t);
+    header.n = network.getNumNodes();
+    header.m = network.getNumEdges();
+    header.source = network.getSource();
+    header.sink = network.getSink();
+    header.total_bytes = layoutSharedGraph<index_t, capacity_t>(header, header.n, header.m);
+
+    // the pages are reserved now, so that a full /dev/shm fails here and not with a SIGBUS in the copy
+    void *memory = MAP_FAILED;
+    int error = posix_fallocate(fd, 0, header.total_bytes);
+    if (error == 0) {
+        memory = mmap(nullptr, header.total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        error = errno;
+    }
+    if (memory == MAP_FAILED) {
+        std::cerr << "Failed to size shared memory " << name << ": " << strerror(error) << std::endl;
+        shm_unlink(name.c_str());
+        close(fd);
+        return false;
+    }
+
+    char *base = (char *)memory;
+    network_arrays_t<index_t, capacity_t> arrays = network.getArrays();
+    memcpy(base + header.first_arc, arrays.first_arc, (header.n + 1) * sizeof(index_t));
+    memcpy(base + header.arc_tail, arrays.arc_tail, 2 * header.m * sizeof(index_t));
+    memcpy(base + header.arc_head, arrays.arc_head, 2 * header.m * sizeof(index_t));
+    memcpy(base + header.arc_capacity, arrays.arc_capacity, 2 * header.m * sizeof(capacity_t));
+    memcpy(base + header.arc_reverse, arrays.arc_reverse, 2 * header.m * sizeof(index_t));
+    memcpy(base + header.edge_arc, arrays.edge_arc, header.m * sizeof(index_t));
+    memcpy(base, &header, sizeof(header));
+
+    // the processes waiting in mapSharedNetwork() read the arrays once they see ready
+    __atomic_store_n(&((shared_graph_header_t *)base)->ready, 1, __ATOMIC_RELEASE);
+    munmap(memory, header.total_bytes);
+    close(fd);
+    return true;
+}
+
+enum shared_graph_status_t {
+    SHARED_GRAPH_MAPPED,        // mapped, built from the expected input file
+    SHARED_GRAPH_MISSING,       // no segment with this name, or the leftover of a dead creator (then removed)
+    SHARED_GRAPH_UNUSABLE       // built from another input file, not a network, or never filled: left untouched
+};
+
+// the header of a segment, false if it is not written yet
+inline bool readSharedGraphHeader(int fd, shared_graph_header_t &header) {
+    return pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) && header.ready != 0;
+}
+
+/**
+ * Maps the segment 'name' read-only, waiting for its creator to fill it.
+ * @param expected the input file the segment must have been built from
+ * @param header set to the header of the segment (widths, sizes)
+ * @param mapping set to the start of the mapping, shared by the networks that use it
+ */
+inline shared_graph_status_t mapSharedNetwork(string name, const shared_graph_source_t &expected,
+                                       shared_graph_header_t &header, shared_ptr<void> &mapping) {
+    name = sharedGraphName(name);
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return SHARED_GRAPH_MISSING;
+
+    // the creator holds its lock until the segment is ready: a segment that stays unlocked and not ready
+    // was left by a creator that died (the grace period covers the creator between shm_open() and flock())
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(SHARED_GRAPH_WAIT_MS);
+    auto unlocked_since = chrono::steady_clock::time_point::max();
+    while (!readSharedGraphHeader(fd, header)) {
+        auto now = chrono::steady_clock::now();
+        if (flock(fd, LOCK_SH | LOCK_NB) == 0) {
+            flock(fd, LOCK_UN);
+            unlocked_since = min(unlocked_since, now);
+        }
+        else {
+            unlocked_since = chrono::steady_clock::time_point::max();
+        }
+        if (unlocked_since != chrono::steady_clock::time_point::max() &&
+            now - unlocked_since > chrono::milliseconds(SHARED_GRAPH_STALE_MS) && !readSharedGraphHeader(fd, header)) {
+            std::cerr << "Shared memory " << name << " was left unfinished by a process that stopped, it is removed" << std::endl;
+            shm_unlink(name.c_str());
+            close(fd);
+            return SHARED_GRAPH_MISSING;
+        }
+        if (now > deadline) {
+            std::cerr << "Shared memory " << name << " is still being filled after " << SHARED_GRAPH_WAIT_MS / 1000 << " s" << std::endl;
+            close(fd);
+            return SHARED_GRAPH_UNUSABLE;
+        }
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+
+    struct stat info;
+    if (memcmp(header.magic, SHARED_GRAPH_MAGIC, sizeof(header.magic)) != 0 || fstat(fd, &info) != 0 ||
+        header.total_bytes > (uint64_t)info.st_size) {
+        std::cerr << "Shared memory " << name << " does not hold a network" << std::endl;
+        close(fd);
+        return SHARED_GRAPH_UNUSABLE;
+    }
+    if (!sameSharedGraphSource(header.input, expected)) {
+        std::cerr << "Shared memory " << name << " holds the network of " << header.input.path << " (" << header.input.size
+                  << " bytes), not of " << expected.path << " as it is now: use another name, or remove it with --shm-unlink" << std::endl;
+        close(fd);
+        return SHARED_GRAPH_UNUSABLE;
+    }
+
+    size_t size = info.st_size;
+    void *memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name << ": " << strerror(errno) << std::endl;
+        return SHARED_GRAPH_UNUSABLE;
+    }
+    mapping = shared_ptr<void>(memory, [size](void *start) { munmap(start, size); });
+    return SHARED_GRAPH_MAPPED;
+}
+
+// the arrays of a mapped segment, whose widths must be index_t and capacity_t
+template <typename index_t, typename capacity_t>
+network_arrays_t<index_t, capacity_t> sharedNetworkArrays(const shared_graph_header_t &header, shared_ptr<void> mapping) {
+    const char *base = (const char *)mapping.get();
+    return {(index_t)header.n, (index_t)header.m, (index_t)header.source, (index_t)header.sink,
+            (const index_t *)(base + header.first_arc), (const index_t *)(base + header.arc_tail),
+            (const index_t *)(base + header.arc_head), (const capacity_t *)(base + header.arc_capacity),
+            (const index_t *)(base + header.arc_reverse), (const index_t *)(base + header.edge_arc), mapping};
+}
+
+// removes the name of the segment, the processes that mapped it keep it until they unmap it
+inline bool removeSharedNetwork(string name) {
+    return shm_unlink(sharedGraphName(name).c_str()) == 0;
+}
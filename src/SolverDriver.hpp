@@ -0,0 +1,170 @@
+// Header file that contains the command line driver shared by the Edge based solvers
+// main.cpp, main_pr.cpp and main_auto.cpp only choose the engine, the options, the run, the
+// report and the check are handled here.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+
+#include "SolverSelection.hpp"
+#include "FlowChecker.hpp"
+#include "NodeList.hpp"
+
+using namespace std;
+
+/**
+ * Runs a solver from the command line:
+ *   prog_name inputFileName outputFileName [minCutFileName] [--sources s1,s2,...] [--sinks t1,t2,...]
+ *             [--prune] [--simplify] [--trace traceFileName] [--report reportFileName] [--check] [--dimacs]
+ *             [--output all|nonzero|cut|binary] [--output-threads N] [--threads N]
+ * plus [--engine auto|sequential|parallel] when the engine is "auto".
+ * @param engine "sequential", "parallel", or "auto" to choose it from the statistics of the graph
+ * @param results_path file where the solve time is appended, empty for none
+ * @return the exit code of the program: 0, 1 if the run failed, 3 if --check found an invalid flow
+ */
+inline int runSolverDriver(int argc, char *argv[], string engine, string results_path = "")
+{
+    // split positional arguments from the options
+    vector<char *> args;
+    vector<int> sources, sinks;
+    bool prune = false, simplify = false;
+    string report_path;
+    bool check = false;
+    output_options_t output = {OUTPUT_ALL, false, 1};   // mode, DIMACS flow solution, threads of the output file
+    bool choose_engine = engine == "auto";
+    int num_threads = 0;
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--sources" && i + 1 < argc) {
+            string bad_id;
+            if (!parseNodeList(argv[++i], sources, bad_id)) {
+                cout << "Invalid node id in --sources: " << bad_id << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--sinks" && i + 1 < argc) {
+            string bad_id;
+            if (!parseNodeList(argv[++i], sinks, bad_id)) {
+                cout << "Invalid node id in --sinks: " << bad_id << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--engine" && choose_engine && i + 1 < argc)
+            engine = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            num_threads = atoi(argv[++i]);
+        else if (arg == "--prune")
+            prune = true;
+        else if (arg == "--simplify")
+            simplify = true;
+        else if (arg == "--trace" && i + 1 < argc)
+            TraceRecorder::instance().start(argv[++i]);
+        else if (arg == "--report" && i + 1 < argc)
+            report_path = argv[++i];
+        else if (arg == "--check")
+            check = true;
+        else if (arg == "--dimacs")
+            output.dimacs = true;
+        else if (arg == "--output" && i + 1 < argc) {
+            if (!parseOutputMode(argv[++i], output.mode)) {
+                cout << "Unknown output mode: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--output-threads" && i + 1 < argc)
+            output.num_threads = atoi(argv[++i]);
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.size() < 3) {
+        cout << "Please provide the path to the input file and the output file." << endl;
+        return 1;
+    }
+    if (engine != "auto" && engine != "sequential" && engine != "parallel") {
+        cout << "Unknown engine: " << engine << endl;
+        return 1;
+    }
+
+    // the file is read once for the statistics, the solver and the checker, so that a pipe works too
+    PhaseTimer read_timer;
+    edge_list_t edges;
+    {
+        PhaseTimer::Scope phase(read_timer, "parse");
+        edges = readEdgeList(args[1]);
+    }
+    if (!edges.loaded)
+        return 1;
+
+    if (engine == "auto") {
+        graph_stats_t stats = computeGraphStats(edges, sources, sinks);
+        engine_choice_t choice = chooseEngine(stats, num_threads);
+        engine = choice.engine;
+        num_threads = choice.num_threads;
+        cout << "Engine: " << engine;
+        if (engine == "parallel")
+            cout << " (" << num_threads << " threads)";
+        cout << ", because " << choice.reason << endl;
+    }
+
+    unique_ptr<MaxFlowSolverBase> solver = createSolver(engine, args[1], num_threads, sources, sinks, &edges);
+    if (!solver || !solver->isValid())
+        return 1;
+    solver->getPhaseTimer().merge(read_timer);
+    // the graph of the solver holds the edges now, they are only kept for the checker
+    if (!check)
+        edges = {0, {}, {}, {}, -1, -1, false};
+
+    if (prune)
+        solver->pruneGraph();
+    if (simplify)
+        solver->simplifyGraph();
+
+    chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+    solver->solve();
+    chrono::high_resolution_clock::time_point t2 = chrono::high_resolution_clock::now();
+    auto duration = chrono::duration_cast<chrono::microseconds>(t2 - t1);
+
+    cout << "Max flow: " << solver->getMaxFlow() << endl;
+    cout << "found in: " << duration.count() << " micros" << endl;
+    if (!results_path.empty()) {
+        ofstream fout(results_path, ios_base::out | ios_base::app);
+        fout << "found in: " << duration.count() << " micros" << endl;
+    }
+
+    {
+        PhaseTimer::Scope phase(solver->getPhaseTimer(), "output");
+        solver->writeFlowToFile(args[2], output);
+
+        if (args.size() > 3) {
+            vector<Edge *> cut = solver->computeMinCut();
+            cout << "Min cut: " << cut.size() << " edges" << endl;
+            solver->printMinCutToFile(args[3]);
+        }
+    }
+
+    // certificate of the output file: valid flow, and a cut with the same capacity
+    bool certified = true;
+    if (check) {
+        PhaseTimer::Scope phase(solver->getPhaseTimer(), "check");
+        certificate_t certificate = checkFlowFile(edges, args[2], sources, sinks);
+        cout << certificateToString(certificate) << endl;
+        certified = certificate.valid;
+    }
+
+    // one JSON line per run with the time of every phase, also appended to the report file if given
+    string record = runRecord(solver->getName(), args[1], solver->getMaxFlow(), solver->getPhaseTimer());
+    cout << record << endl;
+    if (!report_path.empty()) {
+        ofstream report(report_path, ios_base::out | ios_base::app);
+        report << record << endl;
+    }
+
+    return certified ? 0 : 3;
+}
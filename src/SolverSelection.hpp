@@ -0,0 +1,172 @@
+// Header file that contains the automatic choice of the Maximum Flow engine
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <algorithm>
+
+#include "MaxFlowSolver.hpp"
+#include "MaxFlowSolverParallelPool.hpp"
+
+using namespace std;
+
+// statistics of the input graph, cheap enough to be computed while the file is read
+typedef struct {
+    int n;                  // number of nodes
+    long m;                 // number of edges
+    double avg_degree;      // m / n, as in the benchmarks of the README
+    int max_degree;         // in + out edges of the busiest node
+    double degree_skew;     // max_degree / average (in + out) degree
+    long min_capacity;
+    long max_capacity;
+    int source_degree;      // edges leaving the source(s)
+    int sink_degree;        // edges entering the sink(s)
+} graph_stats_t;
+
+// engine picked for a graph, with the reason of the choice
+typedef struct {
+    string engine;          // "sequential" or "parallel"
+    int num_threads;        // threads of the pool (parallel engine only)
+    string reason;
+} engine_choice_t;
+
+/**
+ * Computes the statistics of the edges of the input file, without building the graph.
+ * @param sources, sinks the terminals of the solve; empty means the terminals of the input file
+ */
+inline graph_stats_t computeGraphStats(const edge_list_t &edges, vector<int> sources = {}, vector<int> sinks = {}) {
+    graph_stats_t stats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    if (!edges.loaded) {
+        return stats;
+    }
+
+    stats.n = edges.n;
+    if (sources.empty())
+        sources.push_back(edgeListSource(edges));
+    if (sinks.empty())
+        sinks.push_back(edgeListSink(edges));
+
+    vector<char> is_source(stats.n, 0), is_sink(stats.n, 0);
+    for (int source : sources)
+        if (source >= 0 && source < stats.n) is_source[source] = 1;
+    for (int sink : sinks)
+        if (sink >= 0 && sink < stats.n) is_sink[sink] = 1;
+
+    vector<int> degree(stats.n, 0);
+    stats.min_capacity = __LONG_LONG_MAX__;
+    for (size_t i = 0; i < edges.tails.size(); i++) {
+        int start_node = edges.tails[i];
+        int end_node = edges.heads[i];
+        long capacity = edges.capacities[i];
+
+        stats.m++;
+        degree[start_node]++;
+        degree[end_node]++;
+        stats.min_capacity = min(stats.min_capacity, capacity);
+        stats.max_capacity = max(stats.max_capacity, capacity);
+        stats.source_degree += is_source[start_node];
+        stats.sink_degree += is_sink[end_node];
+    }
+
+    if (stats.m == 0)
+        stats.min_capacity = 0;
+    if (stats.n > 0) {
+        stats.avg_degree = (double)stats.m / stats.n;
+        stats.max_degree = *max_element(degree.begin(), degree.end());
+        stats.degree_skew = stats.m > 0 ? stats.max_degree / (2.0 * stats.avg_degree) : 0;
+    }
+    return stats;
+}
+
+// reads the input file once and computes its statistics
+inline graph_stats_t computeGraphStats(string input_file_path, vector<int> sources = {}, vector<int> sinks = {}) {
+    return computeGraphStats(readEdgeList(input_file_path), sources, sinks);
+}
+
+/* Cost model, in units of one arc scanned by the sequential dfs, for one augmenting path:
+    - sequential: every arc may be scanned once, so the cost is m.
+    - parallel with p threads: every arc is a job that locks two nodes and goes through the
+      queue (PARALLEL_ARC_COST times a sequential scan), spread over the threads that can
+      really work at the same time, plus the wake-up and completion wait of each thread.
+      The labels of a node are handed to at most avg_degree / 2 new jobs, and a skewed graph
+      serializes on its hubs, which bounds the useful threads.
+   The constants reproduce the benchmarks of the README: the parallel version only wins from
+   a degree of ~12 and never on graphs with a few thousand edges. */
+const double PARALLEL_ARC_COST = 4.0;
+const double PARALLEL_SYNC_COST = 500.0;
+const double MAX_DEGREE_SKEW = 10.0;
+
+inline double sequentialCost(const graph_stats_t &stats) {
+    return stats.m;
+}
+
+inline double parallelCost(const graph_stats_t &stats, int num_threads) {
+    double useful_threads = min((double)num_threads, max(1.0, stats.avg_degree / 2));
+    if (stats.degree_skew > MAX_DEGREE_SKEW)
+        useful_threads = max(1.0, useful_threads * MAX_DEGREE_SKEW / stats.degree_skew);
+    return PARALLEL_ARC_COST * stats.m / useful_threads + PARALLEL_SYNC_COST * num_threads;
+}
+
+/**
+ * Chooses the engine and its number of threads from the statistics of the graph.
+ * @param max_threads threads available, 0 means hardware concurrency
+ */
+inline engine_choice_t chooseEngine(const graph_stats_t &stats, int max_threads = 0) {
+    if (max_threads <= 0)
+        max_threads = std::thread::hardware_concurrency();
+
+    if (stats.source_degree == 0 || stats.sink_degree == 0)
+        return {"sequential", 1, "no edge leaves the source or enters the sink, the max flow is 0"};
+    if (max_threads < 2)
+        return {"sequential", 1, "only one hardware thread is available"};
+
+    int best_threads = 2;
+    for (int p = 3; p <= max_threads; p++) {
+        if (parallelCost(stats, p) < parallelCost(stats, best_threads))
+            best_threads = p;
+    }
+
+    double seq_cost = sequentialCost(stats);
+    double par_cost = parallelCost(stats, best_threads);
+    stringstream reason;
+    reason << "n=" << stats.n << " m=" << stats.m << " degree=" << stats.avg_degree
+           << " skew=" << stats.degree_skew << " capacities=[" << stats.min_capacity << ", " << stats.max_capacity << "]"
+           << " source/sink degree=" << stats.source_degree << "/" << stats.sink_degree
+           << ": estimated cost per augmenting path " << seq_cost << " sequential vs "
+           << par_cost << " parallel with " << best_threads << " threads";
+
+    if (par_cost < seq_cost)
+        return {"parallel", best_threads, reason.str()};
+    return {"sequential", 1, reason.str()};
+}
+
+/**
+ * Creates the solver of the given engine ("sequential" or "parallel") for the input file.
+ * @param read_edges the edges of the input file if they were read already, nullptr to read the file
+ * @return the solver, or nullptr for an unknown engine
+ */
+inline unique_ptr<MaxFlowSolverBase> createSolver(string engine, string input_file_path, int num_threads = 0,
+                                           vector<int> sources = {}, vector<int> sinks = {},
+                                           const edge_list_t *read_edges = nullptr) {
+    bool terminals = !sources.empty() || !sinks.empty();
+    if (engine == "sequential") {
+        if (terminals)
+            return unique_ptr<MaxFlowSolverBase>(new MaxFlowSolver(input_file_path, sources, sinks, read_edges));
+        return unique_ptr<MaxFlowSolverBase>(new MaxFlowSolver(input_file_path, read_edges));
+    }
+    if (engine == "parallel") {
+        MaxFlowSolverParallelPool *solver = terminals
+            ? new MaxFlowSolverParallelPool(input_file_path, sources, sinks, read_edges)
+            : new MaxFlowSolverParallelPool(input_file_path, read_edges);
+        solver->setNumThreads(num_threads);
+        return unique_ptr<MaxFlowSolverBase>(solver);
+    }
+    std::cerr << "Unknown engine: " << engine << std::endl;
+    return nullptr;
+}
@@ -1,3 +1,4 @@
+#pragma once
 #include <iostream>
 #include <mutex>
 #include <thread>
@@ -5,12 +6,18 @@
 #include <chrono>
 #include <vector>
 #include <map>
+#include <deque>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <cstdint>
+#include <algorithm>
 
 // Thread-safe logger
 class Logger
 {
 private:
-    static std::mutex cout_mutex;
+    inline static std::mutex cout_mutex;
     std::stringstream buffer;
 
 public:
@@ -31,3 +38,159 @@ public:
     }
 };
 
+
+// a complete event of the timeline: name, start and duration in nanoseconds
+typedef struct {
+    const char *name;
+    int64_t start;
+    int64_t duration;
+} trace_event_t;
+
+// Timeline recorder: every thread writes its events into its own ring buffer, without locks
+// (the oldest events are overwritten when it is full). At exit the buffers are written as a
+// Chrome trace JSON file, which can be opened with chrome://tracing or https://ui.perfetto.dev
+class TraceRecorder
+{
+private:
+    struct ThreadBuffer
+    {
+        int tid;
+        uint64_t count = 0;     // events recorded so far, the ring keeps the last ones
+        std::vector<trace_event_t> events;
+    };
+
+    // a deque never moves its elements, so a buffer stays valid while new ones are added
+    std::mutex buffers_mutex;
+    std::deque<ThreadBuffer> buffers;
+
+    std::atomic<bool> enabled{false};
+    std::string path;
+    size_t events_per_thread = 1 << 16;
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    // buffer of the calling thread, allocated at its first event
+    ThreadBuffer &localBuffer()
+    {
+        thread_local ThreadBuffer *buffer = nullptr;
+        if (!buffer)
+        {
+            std::lock_guard<std::mutex> lock(buffers_mutex);
+            buffers.emplace_back();
+            buffer = &buffers.back();
+            buffer->tid = buffers.size();
+            buffer->events.resize(events_per_thread);
+        }
+        return *buffer;
+    }
+
+    TraceRecorder() {}
+
+public:
+    static TraceRecorder &instance()
+    {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    // start recording; the trace is written to 'path' at exit
+    void start(const std::string &path, size_t events_per_thread = 1 << 16)
+    {
+#ifndef MAXFLOW_TRACE
+        std::cerr << "Tracing is not compiled in, rebuild with -DMAXFLOW_TRACE" << std::endl;
+        return;
+#endif
+        this->path = path;
+        this->events_per_thread = events_per_thread;
+        this->enabled.store(true, std::memory_order_relaxed);
+    }
+
+    bool isEnabled()
+    {
+        return this->enabled.load(std::memory_order_relaxed);
+    }
+
+    // nanoseconds since the recorder was created
+    int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    void record(const char *name, int64_t start, int64_t end)
+    {
+        ThreadBuffer &buffer = localBuffer();
+        buffer.events[buffer.count % buffer.events.size()] = {name, start, end - start};
+        buffer.count++;
+    }
+
+    // write the events of every thread as a Chrome trace, to be called once the threads are done
+    void dump()
+    {
+        if (!isEnabled())
+            return;
+        std::ofstream file(this->path);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open file: " << this->path << std::endl;
+            return;
+        }
+
+        // timestamps in microseconds with the nanoseconds kept: the default format drops them after 1 s
+        file << std::fixed << std::setprecision(3);
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        file << "{\"traceEvents\": [\n";
+        bool first = true;
+        for (ThreadBuffer &buffer : buffers)
+        {
+            file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+                 << buffer.tid << ", \"args\": {\"name\": \"thread " << buffer.tid << "\"}}";
+            first = false;
+
+            uint64_t size = std::min<uint64_t>(buffer.count, buffer.events.size());
+            for (uint64_t i = buffer.count - size; i < buffer.count; i++)
+            {
+                const trace_event_t &event = buffer.events[i % buffer.events.size()];
+                file << ",\n{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer.tid
+                     << ", \"ts\": " << event.start / 1000.0 << ", \"dur\": " << event.duration / 1000.0 << "}";
+            }
+        }
+        file << "\n]}\n";
+        std::cout << "Trace saved to " << this->path << std::endl;
+        this->enabled.store(false);
+    }
+
+    // the trace is written when the program exits, after every thread has been joined
+    ~TraceRecorder()
+    {
+        dump();
+    }
+};
+
+// records the time spent in the enclosing scope as one event
+class TraceScope
+{
+private:
+    const char *name;
+    int64_t start;
+
+public:
+    TraceScope(const char *name) : name(name), start(-1)
+    {
+        if (TraceRecorder::instance().isEnabled())
+            this->start = TraceRecorder::instance().now();
+    }
+
+    ~TraceScope()
+    {
+        if (this->start >= 0)
+            TraceRecorder::instance().record(this->name, this->start, TraceRecorder::instance().now());
+    }
+};
+
+// The events are compiled in only with -DMAXFLOW_TRACE, otherwise TRACE_SCOPE is a no-op
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#ifdef MAXFLOW_TRACE
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
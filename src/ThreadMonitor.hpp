@@ -1,35 +1,133 @@
+#pragma once
 #include <iostream>
 #include <mutex>
 #include <thread>
 #include <sstream>
 #include <chrono>
 #include <vector>
-#include <map>
+#include <deque>
+#include <atomic>
+#include <cstdint>
 #include "ThreadLogger.hpp"
+#include "CacheLine.hpp"
 
-std::mutex Logger::cout_mutex;
+// hot-path events counted by the solvers
+enum counter_t {
+    JOBS_EXECUTED,
+    LABEL_ATTEMPTS,
+    LABEL_FAILURES,
+    LOCK_ACQUISITIONS,
+    LOCK_CONTENDED,
+    AUGMENTATIONS,
+    ARCS_SCANNED,
+    RESET_PASSES,
+    NUM_COUNTERS
+};
+
+constexpr const char *counter_names[NUM_COUNTERS] = {
+    "jobs_executed", "label_attempts", "label_failures", "lock_acquisitions",
+    "lock_contended", "augmentations", "arcs_scanned", "reset_passes"
+};
+
+// counters of one thread, alone on its cache line so that threads never write to a shared line
+struct alignas(CACHE_LINE_SIZE) thread_counters_t {
+    uint64_t values[NUM_COUNTERS] = {};
+};
+
+// The counters are compiled in only with -DMAXFLOW_COUNTERS, otherwise MONITOR_ADD is a no-op
+#ifdef MAXFLOW_COUNTERS
+#define MONITOR_ADD(monitor, counter, value) (monitor).add(counter, value)
+#else
+#define MONITOR_ADD(monitor, counter, value) ((void)0)
+#endif
 
-// Thread state tracker
+// Thread counters: every thread increments its own slot without any synchronization, the slots
+// are only summed once the threads are done (e.g. after ThreadPool::Stop())
 class ThreadMonitor
 {
 private:
-    std::mutex state_mutex;
-    std::map<std::thread::id, std::string> thread_states;
+    // a deque never moves its elements, so a slot stays valid while new ones are added
+    std::mutex slots_mutex;
+    std::deque<thread_counters_t> slots;
+    // the thread that owns each slot, in the same order
+    std::vector<std::thread::id> slot_owners;
+
+    // unique id of this monitor, to tell it apart from a previous monitor at the same address
+    uint64_t id;
+    inline static std::atomic<uint64_t> next_id{0};
+
+    // slot of the calling thread in this monitor, taken at its first event. A thread caches only its
+    // last (monitor, slot) pair, so nothing grows with the monitors it has seen; a thread alternating
+    // between two monitors finds its slot again among the slots of the monitor
+    thread_counters_t &localSlot()
+    {
+        thread_local uint64_t last_id = 0;
+        thread_local thread_counters_t *last_slot = nullptr;
+        if (last_id == this->id)
+            return *last_slot;
+
+        std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(slots_mutex);
+        size_t k = 0;
+        while (k < slot_owners.size() && slot_owners[k] != self)
+            k++;
+        if (k == slot_owners.size())
+        {
+            slots.emplace_back();
+            slot_owners.push_back(self);
+        }
+        last_id = this->id;
+        last_slot = &slots[k];
+        return *last_slot;
+    }
 
 public:
-    void updateState(const std::string &state)
+    ThreadMonitor()
+    {
+        this->id = ++next_id;
+    }
+
+    void add(counter_t counter, uint64_t value = 1)
     {
-/*         std::lock_guard<std::mutex> lock(state_mutex);
-        thread_states[std::this_thread::get_id()] = state; */
+        localSlot().values[counter] += value;
     }
 
-    void dumpState()
+    // sum of a counter over all threads, to be called once the threads are done
+    uint64_t total(counter_t counter)
     {
-/*         std::lock_guard<std::mutex> lock(state_mutex);
-        Logger() << "=== Thread States ===";
-        for (const auto &[thread_id, state] : thread_states)
+        std::lock_guard<std::mutex> lock(slots_mutex);
+        uint64_t sum = 0;
+        for (const thread_counters_t &slot : slots)
+            sum += slot.values[counter];
+        return sum;
+    }
+
+    // the totals and the counters of every thread, as a JSON object
+    std::string toJSON(const std::string &engine)
+    {
+        std::stringstream json;
+        json << "{\"engine\": \"" << engine << "\", \"totals\": {";
+        for (int c = 0; c < NUM_COUNTERS; c++)
+            json << (c ? ", " : "") << "\"" << counter_names[c] << "\": " << total((counter_t)c);
+        json << "}, \"threads\": [";
+
+        std::lock_guard<std::mutex> lock(slots_mutex);
+        for (size_t i = 0; i < slots.size(); i++)
         {
-            Logger() << "Thread " << thread_id << ": " << state;
-        } */
+            json << (i ? ", " : "") << "{";
+            for (int c = 0; c < NUM_COUNTERS; c++)
+                json << (c ? ", " : "") << "\"" << counter_names[c] << "\": " << slots[i].values[c];
+            json << "}";
+        }
+        json << "]}";
+        return json.str();
+    }
+
+    // print the counters as one JSON line (only when they are compiled in)
+    void dumpState([[maybe_unused]] const std::string &engine)
+    {
+#ifdef MAXFLOW_COUNTERS
+        Logger() << toJSON(engine);
+#endif
     }
 };
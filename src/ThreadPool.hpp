@@ -1,4 +1,5 @@
 // pool
+#pragma once
 #include <iostream>
 #include <functional>
 #include <mutex>
@@ -8,11 +9,12 @@
 #include <condition_variable>
 #include <atomic>
 #include "ThreadMonitor.hpp"
+#include "CacheLine.hpp"
 
 class ThreadPool
 {
 public:
-    void Start();
+    void Start(int num_threads = 0);
     void QueueJob(const std::function<void()> &job);
     void Stop();
     bool busy();
@@ -23,15 +25,18 @@ public:
     // void resetJobEnqueued();
     void waitForCompletion();
     void notify();
-    // ThreadMonitor &getMonitor() { return monitor; }
+    ThreadMonitor &getMonitor() { return monitor; }
 
 private:
     void ThreadLoop();
+    // Each control block starts on its own cache line: should_terminate is read by every worker
+    // on every wake up, while active_tasks is written at every queued and finished job.
+
     // Tells threads to stop looking for jobs
-    std::atomic<bool> should_terminate{false};
+    CACHE_ALIGNED std::atomic<bool> should_terminate{false};
 
     // Prevents data races to the job queue
-    std::mutex queue_mutex;
+    CACHE_ALIGNED std::mutex queue_mutex;
     std::condition_variable mutex_condition;
 
     // Allows threads to wait on new jobs or termination std::condition_variable mutex_condition;
@@ -41,20 +46,22 @@ private:
     std::condition_variable cv_completion;
     std::mutex completion_mutex;
 
-    std::atomic<int> active_tasks{0};
+    // queued jobs not finished yet
+    CACHE_ALIGNED std::atomic<int> active_tasks{0};
 
-    ThreadMonitor monitor;
+    CACHE_ALIGNED ThreadMonitor monitor;
 };
 
-void ThreadPool::Start()
+inline void ThreadPool::Start(int num_threads)
 {
-    // Max # of threads the system supports
-    const int num_threads = std::thread::hardware_concurrency();
+    // Max # of threads the system supports, unless a number is given
+    if (num_threads <= 0)
+        num_threads = std::thread::hardware_concurrency();
     cout << "THREADS " << num_threads << endl;
     // std::thread::hardware_concurrency();
     // threads.resize(num_threads);
     // Logger() << "Starting " << num_threads << " threads";
-    for (uint32_t i = 1; i < num_threads + 1; i++)
+    for (int i = 1; i < num_threads + 1; i++)
     {
         threads.emplace_back(&ThreadPool::ThreadLoop, this);
     }
@@ -62,7 +69,7 @@ void ThreadPool::Start()
     return;
 }
 
-void ThreadPool::ThreadLoop()
+inline void ThreadPool::ThreadLoop()
 {
     while (true)
     {
@@ -72,6 +79,7 @@ void ThreadPool::ThreadLoop()
             std::unique_lock<std::mutex> lock(queue_mutex);
             // Logger() << "locked queue mutex";
 
+            TRACE_SCOPE("wait_job");
             mutex_condition.wait(lock, [this]()
                 {
             // Logger() << "thread IS WAITING seeing " << !jobs.empty() << should_terminate.load(); 
@@ -92,6 +100,7 @@ void ThreadPool::ThreadLoop()
         }
 
         job();
+        MONITOR_ADD(monitor, JOBS_EXECUTED, 1);
         size_t remaining = --active_tasks;
         if (remaining == 0)
         {
@@ -106,7 +115,7 @@ void ThreadPool::ThreadLoop()
     }
 }
 
-void ThreadPool::QueueJob(const std::function<void()> &job)
+inline void ThreadPool::QueueJob(const std::function<void()> &job)
 {
 
     std::lock_guard<std::mutex> lock(queue_mutex);
@@ -121,7 +130,7 @@ void ThreadPool::QueueJob(const std::function<void()> &job)
     mutex_condition.notify_one();
 }
 
-bool ThreadPool::busy()
+inline bool ThreadPool::busy()
 {
     bool poolbusy;
     {
@@ -133,7 +142,7 @@ bool ThreadPool::busy()
     return poolbusy;
 }
 
-void ThreadPool::Stop()
+inline void ThreadPool::Stop()
 {
     {
         std::unique_lock<std::mutex> lock(queue_mutex);
@@ -149,7 +158,7 @@ void ThreadPool::Stop()
     threads.clear();
 }
 
-void ThreadPool::clearQueue()
+inline void ThreadPool::clearQueue()
 {
     // Clear the jobs queue
     {
@@ -162,8 +171,9 @@ void ThreadPool::clearQueue()
     }
 }
 
-void ThreadPool::waitForCompletion()
+inline void ThreadPool::waitForCompletion()
 {
+    TRACE_SCOPE("wait_completion");
     // std::unique_lock<std::mutex> lock(completion_mutex);
     // {
     //     // getMonitor().updateState("waiting for completion");
@@ -183,7 +193,7 @@ void ThreadPool::waitForCompletion()
     // getMonitor().updateState("done waiting for completion");
 }
 
-void ThreadPool::notify()
+inline void ThreadPool::notify()
 {
     mutex_condition.notify_all();
 }
\ No newline at end of file
@@ -0,0 +1,155 @@
+// Header file that contains the vertex orderings
+// The ids of the input files have no relation with the structure of the graph: renumbering the nodes
+// before the CSR build puts nodes that are traversed together next to each other in the arrays.
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+#include "FlowNetwork.hpp"
+
+using namespace std;
+
+enum vertex_order_t {
+    ORDER_NONE,     // ids of the input file
+    ORDER_BFS,      // breadth-first from the source, ignoring the direction of the edges
+    ORDER_RCM,      // reverse Cuthill-McKee: small bandwidth of the adjacency matrix
+    ORDER_DEGREE    // decreasing degree: the hubs share the first cache lines
+};
+
+constexpr const char *vertex_order_names[] = {"none", "bfs", "rcm", "degree"};
+
+// the edges of every node in both directions, as arrays (CSR)
+typedef struct {
+    vector<uint64_t> first;
+    vector<uint64_t> neighbours;
+} undirected_graph_t;
+
+inline undirected_graph_t undirectedGraph(const edge_list_t &edges) {
+    undirected_graph_t graph;
+    graph.first = vector<uint64_t>(edges.n + 1, 0);
+    for (size_t i = 0; i < edges.tails.size(); i++) {
+        graph.first[edges.tails[i] + 1]++;
+        graph.first[edges.heads[i] + 1]++;
+    }
+    for (uint64_t u = 0; u < edges.n; u++) {
+        graph.first[u + 1] += graph.first[u];
+    }
+    vector<uint64_t> next(graph.first.begin(), graph.first.end() - 1);
+    graph.neighbours = vector<uint64_t>(2 * edges.tails.size());
+    for (size_t i = 0; i < edges.tails.size(); i++) {
+        graph.neighbours[next[edges.tails[i]]++] = edges.heads[i];
+        graph.neighbours[next[edges.heads[i]]++] = edges.tails[i];
+    }
+    return graph;
+}
+
+/**
+ * Appends to 'order' the nodes reached from 'start' by a breadth-first search.
+ * @param by_degree visits the neighbours of a node by increasing degree (Cuthill-McKee)
+ */
+inline void breadthFirstOrder(const undirected_graph_t &graph, uint64_t start, bool by_degree,
+                       vector<char> &placed, vector<uint64_t> &order) {
+    size_t head = order.size();
+    placed[start] = 1;
+    order.push_back(start);
+    vector<uint64_t> next_nodes;
+    while (head < order.size()) {
+        uint64_t u = order[head++];
+        next_nodes.clear();
+        for (uint64_t k = graph.first[u]; k < graph.first[u + 1]; k++) {
+            uint64_t v = graph.neighbours[k];
+            if (!placed[v]) {
+                placed[v] = 1;
+                next_nodes.push_back(v);
+            }
+        }
+        if (by_degree) {
+            stable_sort(next_nodes.begin(), next_nodes.end(), [&graph](uint64_t a, uint64_t b) {
+                return graph.first[a + 1] - graph.first[a] < graph.first[b + 1] - graph.first[b];
+            });
+        }
+        order.insert(order.end(), next_nodes.begin(), next_nodes.end());
+    }
+}
+
+/**
+ * Computes a new id for every node of the edges.
+ * @param source start of the bfs and rcm orders, the query source of the file (the nodes it does not
+ *        reach follow, one component at a time)
+ * @return new_id[u] for every node u of the input file, empty for ORDER_NONE
+ */
+inline vector<uint64_t> computeVertexOrder(const edge_list_t &edges, vertex_order_t order_type, uint64_t source = 0) {
+    if (order_type == ORDER_NONE || !edges.loaded || edges.n == 0) {
+        return {};
+    }
+    undirected_graph_t graph = undirectedGraph(edges);
+    auto degree = [&graph](uint64_t u) { return graph.first[u + 1] - graph.first[u]; };
+
+    // order[k] is the input id of the node placed k-th
+    vector<uint64_t> order;
+    order.reserve(edges.n);
+    vector<char> placed(edges.n, 0);
+
+    if (order_type == ORDER_BFS) {
+        breadthFirstOrder(graph, min(source, edges.n - 1), false, placed, order);
+        for (uint64_t u = 0; u < edges.n; u++) {
+            if (!placed[u])
+                breadthFirstOrder(graph, u, false, placed, order);
+        }
+    }
+    else if (order_type == ORDER_RCM) {
+        // the component of the source starts from the source, every other one from its node of least
+        // degree, then the whole order is reversed
+        breadthFirstOrder(graph, min(source, edges.n - 1), true, placed, order);
+        vector<uint64_t> by_degree(edges.n);
+        for (uint64_t u = 0; u < edges.n; u++)
+            by_degree[u] = u;
+        stable_sort(by_degree.begin(), by_degree.end(), [&degree](uint64_t a, uint64_t b) {
+            return degree(a) < degree(b);
+        });
+        for (uint64_t u : by_degree) {
+            if (!placed[u])
+                breadthFirstOrder(graph, u, true, placed, order);
+        }
+        reverse(order.begin(), order.end());
+    }
+    else {
+        for (uint64_t u = 0; u < edges.n; u++)
+            order.push_back(u);
+        stable_sort(order.begin(), order.end(), [&degree](uint64_t a, uint64_t b) {
+            return degree(a) > degree(b);
+        });
+    }
+
+    vector<uint64_t> new_id(edges.n);
+    for (uint64_t k = 0; k < edges.n; k++) {
+        new_id[order[k]] = k;
+    }
+    return new_id;
+}
+
+// renames the end nodes of every edge, the edges keep their order (and the arcs of a node their order)
+inline void relabelEdges(edge_list_t &edges, const vector<uint64_t> &new_id) {
+    if (new_id.empty())
+        return;
+    for (size_t i = 0; i < edges.tails.size(); i++) {
+        edges.tails[i] = new_id[edges.tails[i]];
+        edges.heads[i] = new_id[edges.heads[i]];
+    }
+    // the terminals follow their nodes, also the default ones (node 0 and node n-1) of a plain file
+    edges.source = new_id[edgeListSource(edges)];
+    edges.sink = new_id[edgeListSink(edges)];
+}
+
+// the inverse mapping: input id of every new id
+inline vector<uint64_t> invertVertexOrder(const vector<uint64_t> &new_id) {
+    vector<uint64_t> original_id(new_id.size());
+    for (uint64_t u = 0; u < new_id.size(); u++) {
+        original_id[new_id[u]] = u;
+    }
+    return original_id;
+}
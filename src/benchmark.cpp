@@ -0,0 +1,293 @@
+// Benchmark of every engine over the graphs of a directory
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#include "SolverSelection.hpp"
+#include "MaxFlowQueryEngine.hpp"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <filesystem>
+
+using namespace std;
+using namespace chrono;
+
+// times of the trials of one engine on one file, in microseconds
+typedef struct {
+    string file;
+    string engine;
+    int num_threads;
+    int n;
+    long m;
+    vector<double> load_times;
+    vector<double> solve_times;
+    long max_flow;
+    int failures;   // trials whose solver or engine could not be built (file not loaded, widths too narrow)
+    bool agree;     // same max flow as every other engine on this file
+} bench_result_t;
+
+// summary of a set of times
+typedef struct {
+    double median;
+    double p95;
+    double stddev;
+} time_stats_t;
+
+time_stats_t summarize(vector<double> times)
+{
+    time_stats_t stats = {0, 0, 0};
+    if (times.empty())
+        return stats;
+    sort(times.begin(), times.end());
+    size_t k = times.size();
+    stats.median = k % 2 ? times[k / 2] : (times[k / 2 - 1] + times[k / 2]) / 2;
+    // nearest-rank percentile
+    stats.p95 = times[(size_t)ceil(0.95 * k) - 1];
+
+    double mean = 0;
+    for (double time : times)
+        mean += time;
+    mean /= k;
+    double var = 0;
+    for (double time : times)
+        var += (time - mean) * (time - mean);
+    stats.stddev = k > 1 ? sqrt(var / (k - 1)) : 0;
+    return stats;
+}
+
+double elapsedMicros(steady_clock::time_point t1, steady_clock::time_point t2)
+{
+    return duration_cast<nanoseconds>(t2 - t1).count() / 1000.0;
+}
+
+/* One trial of an engine: "sequential", "parallel" or "parallel:<threads>" through the common
+   solver interface, "queries" or "queries:<widths>" through MaxFlowQueryEngine (one query between
+   the terminals of the file, so that every engine solves the same problem), with the widths chosen
+   from the file or forced (u32/u32, u32/u64, u64/u64).
+   Returns false, without a max flow, if the file cannot be solved by the engine. */
+bool runTrial(const string &engine, const string &option, const string &path, long &max_flow,
+              double &load_time, double &solve_time)
+{
+    if (engine == "queries") {
+        int width = -1;
+        for (int w = NETWORK_32_32; w <= NETWORK_64_64; w++) {
+            if (option == network_width_names[w])
+                width = w;
+        }
+        steady_clock::time_point t1 = steady_clock::now();
+        unique_ptr<QueryEngineBase> query_engine = loadQueryEngine(path, width);
+        steady_clock::time_point t2 = steady_clock::now();
+        // the file is not loaded, or it does not fit the forced widths
+        if (!query_engine->isLoaded())
+            return false;
+        max_flow = query_engine->solve(query_engine->getSource(), query_engine->getSink());
+        steady_clock::time_point t3 = steady_clock::now();
+        load_time = elapsedMicros(t1, t2);
+        solve_time = elapsedMicros(t2, t3);
+        return true;
+    }
+
+    int num_threads = option.empty() ? 0 : stoi(option);
+    steady_clock::time_point t1 = steady_clock::now();
+    unique_ptr<MaxFlowSolverBase> solver = createSolver(engine, path, num_threads);
+    steady_clock::time_point t2 = steady_clock::now();
+    if (!solver || !solver->isValid())
+        return false;
+    solver->solve();
+    steady_clock::time_point t3 = steady_clock::now();
+    load_time = elapsedMicros(t1, t2);
+    solve_time = elapsedMicros(t2, t3);
+    max_flow = solver->getMaxFlow();
+    return true;
+}
+
+// checks an engine of --engines: a known name, a positive number of threads, known widths
+bool validEngine(const string &spec)
+{
+    string engine = spec.substr(0, spec.find(':'));
+    bool has_option = spec.find(':') != string::npos;
+    string option = has_option ? spec.substr(spec.find(':') + 1) : "";
+    if (engine == "sequential")
+        return !has_option;
+    if (engine == "parallel") {
+        if (!has_option)
+            return true;
+        char *end;
+        long num_threads = strtol(option.c_str(), &end, 10);
+        return !option.empty() && *end == '\0' && num_threads > 0 && num_threads <= 1024;
+    }
+    if (engine == "queries") {
+        if (!has_option)
+            return true;
+        for (int w = NETWORK_32_32; w <= NETWORK_64_64; w++) {
+            if (option == network_width_names[w])
+                return true;
+        }
+    }
+    return false;
+}
+
+// parse a comma separated list, e.g. "sequential,parallel:4"
+vector<string> parseList(string list)
+{
+    vector<string> items;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (!item.empty())
+            items.push_back(item);
+    }
+    return items;
+}
+
+// prog_name [--inputs dir] [--engines e1,e2,...] [--warmup W] [--trials N] [--max-edges M]
+//           [--csv csvFileName] [--json jsonFileName]
+// engines: sequential, parallel, parallel:<threads>, queries, queries:<widths> (u32/u32, u32/u64, u64/u64)
+int main(int argc, char *argv[])
+{
+    string inputs_dir = "inputs";
+    vector<string> engines = {"sequential", "parallel", "queries"};
+    int warmup = 1, trials = 5;
+    long max_edges = 100000;
+    string csv_path, json_path;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--inputs" && i + 1 < argc)
+            inputs_dir = argv[++i];
+        else if (arg == "--engines" && i + 1 < argc) {
+            engines = parseList(argv[++i]);
+            for (const string &spec : engines) {
+                if (!validEngine(spec)) {
+                    cout << "Unknown engine: " << spec << " (sequential, parallel, parallel:<threads>, queries, queries:<widths>)" << endl;
+                    return 1;
+                }
+            }
+        }
+        else if (arg == "--warmup" && i + 1 < argc)
+            warmup = atoi(argv[++i]);
+        else if (arg == "--trials" && i + 1 < argc)
+            trials = max(1, atoi(argv[++i]));
+        else if (arg == "--max-edges" && i + 1 < argc)
+            max_edges = atol(argv[++i]);
+        else if (arg == "--csv" && i + 1 < argc)
+            csv_path = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            json_path = argv[++i];
+        else {
+            cout << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+
+    vector<string> files;
+    for (const auto &entry : filesystem::directory_iterator(inputs_dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".txt")
+            files.push_back(entry.path().string());
+    }
+    sort(files.begin(), files.end());
+
+    vector<bench_result_t> results;
+    for (const string &file : files) {
+        graph_stats_t stats = computeGraphStats(file);
+        string name = filesystem::path(file).filename().string();
+        if (max_edges > 0 && stats.m > max_edges) {
+            cout << "skipping " << name << " (" << stats.m << " edges)" << endl;
+            continue;
+        }
+
+        size_t first = results.size();
+        for (const string &spec : engines) {
+            bench_result_t result;
+            result.file = name;
+            string engine = spec.substr(0, spec.find(':'));
+            string option = spec.find(':') != string::npos ? spec.substr(spec.find(':') + 1) : "";
+            // the widths of the query engine are kept in its name
+            result.engine = engine == "queries" ? spec : engine;
+            result.num_threads = engine != "queries" && !option.empty() ? stoi(option) : 0;
+            result.n = stats.n;
+            result.m = stats.m;
+            result.max_flow = -1;
+            result.failures = 0;
+            result.agree = true;
+
+            // the solvers log to cout, which is silenced during the runs
+            streambuf *cout_buffer = cout.rdbuf(nullptr);
+            for (int trial = 0; trial < warmup + trials; trial++) {
+                long max_flow;
+                double load_time, solve_time;
+                bool solved = runTrial(engine, option, file, max_flow, load_time, solve_time);
+                if (trial < warmup)
+                    continue;
+                if (!solved) {
+                    result.failures++;
+                    continue;
+                }
+                if (result.max_flow != -1 && result.max_flow != max_flow)
+                    result.agree = false;
+                result.max_flow = max_flow;
+                result.load_times.push_back(load_time);
+                result.solve_times.push_back(solve_time);
+            }
+            cout.rdbuf(cout_buffer);
+
+            time_stats_t solve = summarize(result.solve_times);
+            cout << name << " " << spec << ": max flow " << result.max_flow << ", solve median "
+                 << fixed << setprecision(3) << solve.median << " micros";
+            if (result.failures)
+                cout << ", " << result.failures << " failed trials";
+            cout << endl;
+            results.push_back(result);
+        }
+
+        // max flow agreement across the engines that solved the file
+        for (size_t i = first; i < results.size(); i++) {
+            for (size_t j = first; j < results.size(); j++) {
+                if (results[i].solve_times.empty() || results[j].solve_times.empty())
+                    continue;
+                if (results[i].max_flow != results[j].max_flow)
+                    results[i].agree = false;
+            }
+            if (!results[i].agree)
+                cout << "MISMATCH on " << name << ": " << results[i].engine << " found " << results[i].max_flow << endl;
+        }
+    }
+
+    if (!csv_path.empty()) {
+        ofstream csv(csv_path);
+        // times in microseconds to the nanosecond, whatever their magnitude
+        csv << fixed << setprecision(3);
+        csv << "file,engine,threads,nodes,edges,trials,load_median_us,load_p95_us,load_stddev_us,"
+            << "solve_median_us,solve_p95_us,solve_stddev_us,max_flow,failures,agree\n";
+        for (const bench_result_t &r : results) {
+            time_stats_t load = summarize(r.load_times), solve = summarize(r.solve_times);
+            csv << r.file << "," << r.engine << "," << r.num_threads << "," << r.n << "," << r.m << ","
+                << r.solve_times.size() << "," << load.median << "," << load.p95 << "," << load.stddev << ","
+                << solve.median << "," << solve.p95 << "," << solve.stddev << "," << r.max_flow << ","
+                << r.failures << "," << (r.agree ? "true" : "false") << "\n";
+        }
+        cout << "CSV saved to " << csv_path << endl;
+    }
+
+    if (!json_path.empty()) {
+        ofstream json(json_path);
+        json << fixed << setprecision(3);
+        json << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const bench_result_t &r = results[i];
+            time_stats_t load = summarize(r.load_times), solve = summarize(r.solve_times);
+            json << "  {\"file\": \"" << r.file << "\", \"engine\": \"" << r.engine << "\", \"threads\": " << r.num_threads
+                 << ", \"nodes\": " << r.n << ", \"edges\": " << r.m << ", \"trials\": " << r.solve_times.size()
+                 << ", \"load_us\": {\"median\": " << load.median << ", \"p95\": " << load.p95 << ", \"stddev\": " << load.stddev << "}"
+                 << ", \"solve_us\": {\"median\": " << solve.median << ", \"p95\": " << solve.p95 << ", \"stddev\": " << solve.stddev << "}"
+                 << ", \"max_flow\": " << r.max_flow << ", \"failures\": " << r.failures
+                 << ", \"agree\": " << (r.agree ? "true" : "false") << "}"
+                 << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        json << "]\n";
+        cout << "JSON saved to " << json_path << endl;
+    }
+
+    // a mismatch or a failed trial makes the run fail
+    bool all_agree = true;
+    for (const bench_result_t &r : results)
+        all_agree = all_agree && r.agree && r.failures == 0;
+    return all_agree ? 0 : 2;
+}
@@ -0,0 +1,52 @@
+// Checker of the output files of the solvers: valid flow, and maximum thanks to a cut of equal capacity
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#include "FlowChecker.hpp"
+#include "NodeList.hpp"
+#include <chrono>
+
+using namespace std;
+using namespace chrono;
+
+// prog_name inputFileName flowFileName [--sources s1,s2,...] [--sinks t1,t2,...] [--threads N]
+// exit code 0 if the flow is a maximum flow, 3 otherwise
+int main(int argc, char *argv[])
+{
+    vector<char *> args;
+    vector<int> sources, sinks;
+    int num_threads = 0;
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--sources" && i + 1 < argc) {
+            string bad_id;
+            if (!parseNodeList(argv[++i], sources, bad_id)) {
+                cout << "Invalid node id in --sources: " << bad_id << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--sinks" && i + 1 < argc) {
+            string bad_id;
+            if (!parseNodeList(argv[++i], sinks, bad_id)) {
+                cout << "Invalid node id in --sinks: " << bad_id << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+            num_threads = atoi(argv[++i]);
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.size() < 3) {
+        cout << "Please provide the path to the input file and the flow file." << endl;
+        return 1;
+    }
+
+    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+    certificate_t certificate = checkFlowFile(args[1], args[2], sources, sinks, num_threads);
+    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+    auto duration = duration_cast<microseconds>(t2 - t1);
+
+    cout << certificateToString(certificate) << endl;
+    cout << "checked in: " << duration.count() << " micros" << endl;
+    return certificate.valid ? 0 : 3;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+// prog_name socketPath [requestsFileName]
+// sends the requests (one per line, from the file or the standard input) to a MaxFlowServer without
+// waiting for the replies, and prints the replies in the order of the requests
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        cout << "Please provide the path of the socket." << endl;
+        return 1;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, argv[1], sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr *)&address, sizeof(address)) < 0) {
+        std::cerr << "Failed to connect to " << argv[1] << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // the replies are read while the requests are sent, so that neither side blocks on a full socket
+    thread receiver([fd] {
+        char buffer[1 << 16];
+        ssize_t count;
+        while ((count = read(fd, buffer, sizeof(buffer))) > 0 || (count < 0 && errno == EINTR)) {
+            if (count > 0)
+                cout.write(buffer, count);
+        }
+        cout.flush();
+    });
+
+    ifstream file;
+    if (argc > 2) {
+        file.open(argv[2]);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file: " << argv[2] << std::endl;
+            shutdown(fd, SHUT_WR);
+            receiver.join();
+            return 1;
+        }
+    }
+    istream &requests = argc > 2 ? file : cin;
+    string line;
+    while (getline(requests, line)) {
+        line += "\n";
+        if (send(fd, line.data(), line.size(), MSG_NOSIGNAL) < 0)
+            break;
+    }
+
+    // the server closes the connection after the last reply
+    shutdown(fd, SHUT_WR);
+    receiver.join();
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Generator of synthetic flow networks, streamed to the input format of the solvers
+// Author(s): Mick Perseo & Gio Silve & M.N.
+#include "GraphGenerator.hpp"
+#include <chrono>
+
+using namespace std;
+using namespace chrono;
+
+// prog_name outputFileName [--family dag|layered|grid|powerlaw|bipartite] [--nodes N] [--edges M]
+//           [--layers L] [--exponent E] [--min-cap C] [--max-cap C] [--seed S] [--threads T]
+// outputFileName "-" writes to stdout
+int main(int argc, char *argv[])
+{
+    generator_params_t params = {"dag", 1000, 6000, 0, 2.0, 1, 100, 1};
+    string output_path;
+    int num_threads = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--family" && i + 1 < argc)
+            params.family = argv[++i];
+        else if (arg == "--nodes" && i + 1 < argc)
+            params.nodes = atol(argv[++i]);
+        else if (arg == "--edges" && i + 1 < argc)
+            params.edges = atol(argv[++i]);
+        else if (arg == "--layers" && i + 1 < argc)
+            params.layers = atoi(argv[++i]);
+        else if (arg == "--exponent" && i + 1 < argc)
+            params.exponent = atof(argv[++i]);
+        else if (arg == "--min-cap" && i + 1 < argc)
+            params.min_capacity = atol(argv[++i]);
+        else if (arg == "--max-cap" && i + 1 < argc)
+            params.max_capacity = atol(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc)
+            params.seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc)
+            num_threads = atoi(argv[++i]);
+        else if (output_path.empty() && (arg == "-" || arg[0] != '-'))
+            output_path = arg;
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+
+    if (output_path.empty()) {
+        cerr << "Please provide the path to the output file." << endl;
+        return 1;
+    }
+    if (!GraphGenerator::isFamily(params.family)) {
+        cerr << "Unknown family: " << params.family << endl;
+        return 1;
+    }
+    if (params.min_capacity < 0 || params.max_capacity < params.min_capacity) {
+        cerr << "Invalid capacity range" << endl;
+        return 1;
+    }
+
+    FILE *out = output_path == "-" ? stdout : fopen(output_path.c_str(), "w");
+    if (!out) {
+        cerr << "Failed to open file: " << output_path << endl;
+        return 1;
+    }
+    // large buffer: the chunks are written with one call each
+    setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+    GraphGenerator generator(params);
+    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+    long num_edges = generator.write(out, num_threads);
+    if (out != stdout)
+        fclose(out);
+    else
+        fflush(out);
+    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+    auto duration = duration_cast<milliseconds>(t2 - t1);
+
+    // the report goes to stderr, so that stdout can be piped into a solver
+    cerr << params.family << " graph with " << generator.getNumNodes() << " nodes and " << num_edges
+         << " edges saved to " << output_path << " in " << duration.count() << " ms" << endl;
+    return 0;
+}
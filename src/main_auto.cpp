@@ -0,0 +1,11 @@
+#include "SolverDriver.hpp"
+
+using namespace std;
+
+// prog_name inputFileName outputFileName [minCutFileName] [--engine auto|sequential|parallel] [--threads N]
+//           [--sources s1,s2,...] [--sinks t1,t2,...] [--prune] [--simplify] [--trace traceFileName]
+//           [--report reportFileName] [--check] [--dimacs] [--output all|nonzero|cut|binary] [--output-threads N]
+int main(int argc, char *argv[])
+{
+    return runSolverDriver(argc, argv, "auto");
+}
@@ -0,0 +1,134 @@
+#include "MaxFlowQueryEngine.hpp"
+#include <chrono>
+
+using namespace std;
+using namespace chrono;
+
+// prog_name inputFileName queriesFileName outputFileName [numThreads] [--width u32/u32|u32/u64|u64/u64]
+//           [--prefetch] [--huge-pages] [--scan scalar|sse4|avx2] [--reorder none|bfs|rcm|degree]
+//           [--shm segmentName] [--shm-unlink]
+// the queries file has one "source sink" pair per line
+int main(int argc, char *argv[])
+{
+    // the widths are chosen from the input file unless --width forces them
+    vector<char *> args;
+    int width = -1;
+    bool prefetch = false;
+    int scan_kernel = -1;
+    vertex_order_t order = ORDER_NONE;
+    string shm_name;            // shared memory segment of the network, created by the first process
+    bool shm_unlink = false;    // removes the segment at the end of the run
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--width" && i + 1 < argc) {
+            string name = argv[++i];
+            for (int w = NETWORK_32_32; w <= NETWORK_64_64; w++) {
+                if (name == network_width_names[w])
+                    width = w;
+            }
+            if (width == -1) {
+                cout << "Unknown width: " << name << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--scan" && i + 1 < argc) {
+            string name = argv[++i];
+            for (int k = SCAN_SCALAR; k <= SCAN_AVX2; k++) {
+                if (name == scan_kernel_names[k])
+                    scan_kernel = k;
+            }
+            if (scan_kernel == -1) {
+                cout << "Unknown scan kernel: " << name << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--reorder" && i + 1 < argc) {
+            string name = argv[++i];
+            int found = -1;
+            for (int k = ORDER_NONE; k <= ORDER_DEGREE; k++) {
+                if (name == vertex_order_names[k])
+                    found = k;
+            }
+            if (found == -1) {
+                cout << "Unknown vertex order: " << name << endl;
+                return 1;
+            }
+            order = (vertex_order_t)found;
+        }
+        else if (arg == "--shm" && i + 1 < argc)
+            shm_name = argv[++i];
+        else if (arg == "--shm-unlink")
+            shm_unlink = true;
+        else if (arg == "--prefetch")
+            prefetch = true;
+        else if (arg == "--huge-pages")
+            setHugePages(true);
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.size() < 4) {
+        cout << "Please provide the path to the input file, the queries file and the output file." << endl;
+        return 1;
+    }
+
+    if (!shm_name.empty() && order != ORDER_NONE) {
+        cout << "A renumbered network cannot be shared: --shm takes no --reorder" << endl;
+        return 1;
+    }
+
+    // the topology is loaded once and shared by every query (and by every process with --shm)
+    unique_ptr<QueryEngineBase> engine = shm_name.empty() ? loadQueryEngine(args[1], width, order)
+                                                          : loadSharedQueryEngine(args[1], shm_name, width);
+    if (!engine || !engine->isLoaded()) {
+        // a segment refused for another input is removed too, so that the next run recreates it
+        if (shm_unlink && !shm_name.empty())
+            removeSharedNetwork(shm_name);
+        return 1;
+    }
+    cout << "Number of nodes: " << engine->getNumNodes() << endl;
+    if (engine->isShared())
+        cout << "Shared memory: " << sharedGraphName(shm_name) << endl;
+    cout << "Widths: " << engine->getWidthName() << " (" << engine->getMemoryBytes() << " bytes of topology)" << endl;
+    engine->setPrefetch(prefetch);
+    // the kernel detected from the CPU, unless --scan chooses a narrower one
+    if (scan_kernel >= 0 && scan_kernel < detectScanKernel())
+        engine->setScanKernel((scan_kernel_t)scan_kernel);
+    cout << "Arc scan: " << engine->getScanKernelName() << endl;
+    cout << "Vertex order: " << vertex_order_names[order] << endl;
+
+    ifstream fin(args[2]);
+    if (!fin.is_open()) {
+        std::cerr << "Failed to open file: " << args[2] << std::endl;
+        return 1;
+    }
+    vector<pair<long, long>> queries;
+    long s, t;
+    while (fin >> s >> t) {
+        queries.push_back({s, t});
+    }
+    cout << "Number of queries: " << queries.size() << endl;
+
+    int num_threads = args.size() > 4 ? atoi(args[4]) : 0;
+
+    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+    vector<long> results = engine->solveBatch(queries, num_threads);
+    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+    auto duration = duration_cast<microseconds>(t2 - t1);
+
+    cout << "found in: " << duration.count() << " micros" << endl;
+
+    ofstream fout(args[3]);
+    if (!fout.is_open()) {
+        std::cerr << "Failed to open file: " << args[3] << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < queries.size(); i++) {
+        fout << queries[i].first << " " << queries[i].second << " " << results[i] << "\n";
+    }
+
+    if (shm_unlink && !shm_name.empty())
+        removeSharedNetwork(shm_name);
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "MaxFlowServer.hpp"
+
+using namespace std;
+
+// prog_name socketPath [numThreads] [--load name=inputFileName]... [--huge-pages]
+// keeps the graphs loaded and answers the requests of the clients (see MaxFlowServer.hpp) until "shutdown"
+int main(int argc, char *argv[])
+{
+    vector<char *> args;
+    vector<pair<string, string>> preloads;
+    for (int i = 0; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--load" && i + 1 < argc) {
+            string spec = argv[++i];
+            size_t equal = spec.find('=');
+            if (equal == string::npos) {
+                cout << "Expected --load name=inputFileName, got: " << spec << endl;
+                return 1;
+            }
+            preloads.push_back({spec.substr(0, equal), spec.substr(equal + 1)});
+        }
+        else if (arg == "--huge-pages")
+            setHugePages(true);
+        else
+            args.push_back(argv[i]);
+    }
+
+    if (args.size() < 2) {
+        cout << "Please provide the path of the socket." << endl;
+        return 1;
+    }
+
+    int num_threads = args.size() > 2 ? atoi(args[2]) : 0;
+    MaxFlowServer server(args[1], num_threads);
+    for (const auto &preload : preloads) {
+        cout << server.preload(preload.first, preload.second) << endl;
+    }
+    return server.run() ? 0 : 1;
+}